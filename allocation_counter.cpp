@@ -0,0 +1,83 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <unistd.h>
+
+#ifdef SEARCH_SERVER_COUNT_ALLOCATIONS
+
+namespace {
+
+// Перед каждым блоком хранится его размер; смещение сохраняет выравнивание malloc
+constexpr std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+thread_local std::size_t allocation_count = 0;
+std::atomic<std::size_t> allocated_bytes = 0;
+
+} // namespace
+
+
+std::size_t GetAllocationCount() {
+    return allocation_count;
+}
+
+
+std::size_t GetAllocatedBytes() {
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+#else
+
+std::size_t GetAllocationCount() {
+    return 0;
+}
+
+
+std::size_t GetAllocatedBytes() {
+    return 0;
+}
+
+#endif
+
+
+std::size_t GetResidentSetSize() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t total_pages = 0;
+    std::size_t resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+
+#ifdef SEARCH_SERVER_COUNT_ALLOCATIONS
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size + HEADER_SIZE)) {
+        *static_cast<std::size_t*>(ptr) = size;
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        return static_cast<char*>(ptr) + HEADER_SIZE;
+    }
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - HEADER_SIZE;
+    allocated_bytes.fetch_sub(*static_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+// Подсчет обращений к куче заменяет глобальные operator new и delete и поэтому включается только
+// при сборке тестов и замеров с -DSEARCH_SERVER_COUNT_ALLOCATIONS; без него оба счетчика
+// остаются нулевыми, а программа пользуется стандартным распределителем.
+
+#ifdef SEARCH_SERVER_COUNT_ALLOCATIONS
+inline constexpr bool ALLOCATION_COUNTING_ENABLED = true;
+#else
+inline constexpr bool ALLOCATION_COUNTING_ENABLED = false;
+#endif
+
+// Число вызовов глобального operator new в текущем потоке с момента его запуска.
+std::size_t GetAllocationCount();
+
+// Суммарный размер блоков, выделенных через operator new и еще не освобожденных (во всех потоках).
+std::size_t GetAllocatedBytes();
+
+// Резидентная память процесса в байтах по /proc/self/statm; там, где его нет, - ноль
+std::size_t GetResidentSetSize();
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "benchmark_suite.h"
+#include "allocation_counter.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <execution>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+constexpr int FORMAT_VERSION = 1;
+constexpr size_t WARMUP_QUERY_COUNT = 100;
+
+using Clock = chrono::steady_clock;
+
+template <typename Value>
+void ParseValue(string_view key, string_view text, Value& value) {
+    const auto [end, error] = from_chars(text.data(), text.data() + text.size(), value);
+    if (error != errc() || end != text.data() + text.size()) {
+        throw invalid_argument("Invalid value \""s + string(text) + "\" for benchmark parameter "s + string(key));
+    }
+}
+
+
+double ToMicroseconds(Clock::duration duration) {
+    return chrono::duration<double, micro>(duration).count();
+}
+
+
+// Перцентиль по отсортированным замерам, метод ближайшего ранга
+Clock::duration GetPercentile(const vector<Clock::duration>& sorted_durations, double percentile) {
+    const size_t rank = static_cast<size_t>(percentile * static_cast<double>(sorted_durations.size()));
+    return sorted_durations[min(rank, sorted_durations.size() - 1)];
+}
+
+
+void WriteLatencyStats(ostream& output, vector<Clock::duration>& durations) {
+    if (durations.empty()) {
+        output << "\"mean_us\":0,\"p50_us\":0,\"p95_us\":0,\"p99_us\":0,\"max_us\":0";
+        return;
+    }
+    sort(durations.begin(), durations.end());
+    Clock::duration total{0};
+    for (const Clock::duration duration : durations) {
+        total += duration;
+    }
+    output << "\"mean_us\":" << ToMicroseconds(total) / static_cast<double>(durations.size())
+           << ",\"p50_us\":" << ToMicroseconds(GetPercentile(durations, 0.5))
+           << ",\"p95_us\":" << ToMicroseconds(GetPercentile(durations, 0.95))
+           << ",\"p99_us\":" << ToMicroseconds(GetPercentile(durations, 0.99))
+           << ",\"max_us\":" << ToMicroseconds(durations.back());
+}
+
+
+template <typename ExecutionPolicy>
+void BenchmarkFindTopDocuments(ExecutionPolicy&& policy, const SearchServer& search_server, const vector<string>& queries,
+                               ostream& output) {
+    for (size_t i = 0; i < min(WARMUP_QUERY_COUNT, queries.size()); ++i) {
+        search_server.FindTopDocuments(policy, queries[i]);
+    }
+
+    vector<Clock::duration> durations;
+    durations.reserve(queries.size());
+    size_t found = 0;
+    for (const string& query : queries) {
+        const auto start_time = Clock::now();
+        found += search_server.FindTopDocuments(policy, query).size();
+        durations.push_back(Clock::now() - start_time);
+    }
+    output << "{\"queries\":" << queries.size() << ",\"found\":" << found << ',';
+    WriteLatencyStats(output, durations);
+    output << '}';
+}
+
+} // namespace
+
+
+CorpusConfig ParseCorpusConfig(const vector<string_view>& arguments) {
+    CorpusConfig config;
+    for (const string_view argument : arguments) {
+        const size_t separator = argument.find('=');
+        if (separator == string_view::npos) {
+            throw invalid_argument("Benchmark parameter must look like key=value: "s + string(argument));
+        }
+        const string_view key = argument.substr(0, separator);
+        const string_view value = argument.substr(separator + 1);
+        if (key == "vocabulary"sv) {
+            ParseValue(key, value, config.vocabulary_size);
+        } else if (key == "documents"sv) {
+            ParseValue(key, value, config.document_count);
+        } else if (key == "document_length"sv) {
+            ParseValue(key, value, config.document_length);
+        } else if (key == "queries"sv) {
+            ParseValue(key, value, config.query_count);
+        } else if (key == "query_length"sv) {
+            ParseValue(key, value, config.query_length);
+        } else if (key == "zipf"sv) {
+            ParseValue(key, value, config.zipf_exponent);
+        } else if (key == "stop_words"sv) {
+            ParseValue(key, value, config.stop_word_count);
+        } else if (key == "stop_word_ratio"sv) {
+            ParseValue(key, value, config.stop_word_ratio);
+        } else if (key == "minus_word_ratio"sv) {
+            ParseValue(key, value, config.minus_word_ratio);
+        } else if (key == "seed"sv) {
+            ParseValue(key, value, config.seed);
+        } else {
+            throw invalid_argument("Unknown benchmark parameter "s + string(key));
+        }
+    }
+    return config;
+}
+
+
+void RunBenchmarkSuite(const CorpusConfig& config, ostream& output) {
+    CorpusGenerator corpus_generator(config);
+    vector<string> documents;
+    documents.reserve(config.document_count);
+    for (int i = 0; i < config.document_count; ++i) {
+        documents.push_back(corpus_generator.GenerateDocument());
+    }
+    vector<string> queries;
+    queries.reserve(config.query_count);
+    for (int i = 0; i < config.query_count; ++i) {
+        queries.push_back(corpus_generator.GenerateQuery());
+    }
+
+    const size_t bytes_before = GetAllocatedBytes();
+    SearchServer search_server(corpus_generator.GetStopWordsText());
+    const auto indexing_start_time = Clock::now();
+    for (int i = 0; i < config.document_count; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    const Clock::duration indexing_duration = Clock::now() - indexing_start_time;
+    const size_t index_bytes = GetAllocatedBytes() - bytes_before;
+    const IndexMemoryUsage memory_usage = search_server.GetMemoryUsage();
+
+    output.precision(6);
+    output << "{\"format_version\":" << FORMAT_VERSION
+           << ",\"config\":{\"vocabulary\":" << config.vocabulary_size
+           << ",\"documents\":" << config.document_count
+           << ",\"document_length\":" << config.document_length
+           << ",\"queries\":" << config.query_count
+           << ",\"query_length\":" << config.query_length
+           << ",\"zipf\":" << config.zipf_exponent
+           << ",\"stop_words\":" << config.stop_word_count
+           << ",\"stop_word_ratio\":" << config.stop_word_ratio
+           << ",\"minus_word_ratio\":" << config.minus_word_ratio
+           << ",\"seed\":" << config.seed << '}';
+
+    const double indexing_seconds = chrono::duration<double>(indexing_duration).count();
+    output << ",\"add_document\":{\"total_ms\":" << indexing_seconds * 1000.0
+           << ",\"documents_per_second\":" << (indexing_seconds > 0.0 ? config.document_count / indexing_seconds : 0.0) << '}';
+
+    // Без подсчета обращений к куче размер индекса берется из его собственной оценки
+    const size_t measured_bytes = ALLOCATION_COUNTING_ENABLED ? index_bytes : memory_usage.GetTotal();
+    output << ",\"memory\":{\"allocated_bytes\":";
+    if (ALLOCATION_COUNTING_ENABLED) {
+        output << index_bytes;
+    } else {
+        output << "null";
+    }
+    output << ",\"postings_bytes\":" << memory_usage.postings
+           << ",\"terms_bytes\":" << memory_usage.terms
+           << ",\"documents_bytes\":" << memory_usage.documents
+           << ",\"bytes_per_document\":"
+           << (config.document_count > 0 ? static_cast<double>(measured_bytes) / config.document_count : 0.0) << '}';
+
+    output << ",\"find_top_documents\":";
+    BenchmarkFindTopDocuments(execution::seq, search_server, queries, output);
+    output << ",\"find_top_documents_par\":";
+    BenchmarkFindTopDocuments(execution::par, search_server, queries, output);
+
+    // Каждый запрос сопоставляется со случайным документом; генератор отдельный, чтобы
+    // выбор документов не зависел от того, сколько чисел потратил генератор корпуса
+    vector<Clock::duration> match_durations;
+    size_t matched_words = 0;
+    if (config.document_count > 0) {
+        mt19937 document_generator(config.seed);
+        uniform_int_distribution<int> document_distribution(0, config.document_count - 1);
+        match_durations.reserve(queries.size());
+        for (const string& query : queries) {
+            const int document_id = document_distribution(document_generator);
+            const auto start_time = Clock::now();
+            matched_words += get<0>(search_server.MatchDocument(query, document_id)).size();
+            match_durations.push_back(Clock::now() - start_time);
+        }
+    }
+    output << ",\"match_document\":{\"calls\":" << match_durations.size() << ",\"matched_words\":" << matched_words << ',';
+    WriteLatencyStats(output, match_durations);
+    output << "}}" << endl;
+}
\ No newline at end of file
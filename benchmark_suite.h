@@ -0,0 +1,15 @@
+#pragma once
+#include "corpus_generator.h"
+
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// Разбирает параметры вида ключ=значение, например "vocabulary=100000 zipf=1.2 minus_word_ratio=0.3".
+// Не заданные параметры берутся из CorpusConfig по умолчанию.
+CorpusConfig ParseCorpusConfig(const std::vector<std::string_view>& arguments);
+
+// Строит индекс по синтетическому корпусу и замеряет скорость AddDocument, перцентили задержки
+// FindTopDocuments, стоимость MatchDocument и объем памяти индекса. Результат - одна строка JSON,
+// чтобы прогоны разных версий можно было собирать и сравнивать автоматически.
+void RunBenchmarkSuite(const CorpusConfig& config, std::ostream& output);
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "concurrent_search_server.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+
+ConcurrentSearchServer::Snapshot::Snapshot(std::vector<std::shared_ptr<const SearchServer>> segments, std::uint64_t generation)
+    : segments_(std::move(segments)), generation_(generation) {
+    segment_pointers_.reserve(segments_.size());
+    for (const std::shared_ptr<const SearchServer>& segment : segments_) {
+        segment_pointers_.push_back(segment.get());
+    }
+}
+
+
+std::vector<Document> ConcurrentSearchServer::Snapshot::FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                                                         size_t result_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, status, result_count);
+}
+
+
+std::vector<Document> ConcurrentSearchServer::Snapshot::FindTopDocuments(std::string_view raw_query, size_t result_count) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL, result_count);
+}
+
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> ConcurrentSearchServer::Snapshot::MatchDocument(std::string_view raw_query,
+                                                                                                          int document_id) const {
+    const SearchServer* segment = PartitionedSearch(segment_pointers_).FindPart(document_id);
+    if (segment == nullptr) {
+        throw std::out_of_range("Document with this ID is not found");
+    }
+    return segment->MatchDocument(raw_query, document_id);
+}
+
+
+int ConcurrentSearchServer::Snapshot::GetDocumentCount() const {
+    return PartitionedSearch(segment_pointers_).GetDocumentCount();
+}
+
+
+size_t ConcurrentSearchServer::Snapshot::GetSegmentCount() const {
+    return segments_.size();
+}
+
+
+std::uint64_t ConcurrentSearchServer::Snapshot::GetGeneration() const {
+    return generation_;
+}
+
+
+// Небольшой исходный индекс становится дельтой, крупный разрезается на запечатанные сегменты
+ConcurrentSearchServer::ConcurrentSearchServer(SearchServer search_server, size_t delta_document_limit, size_t segment_document_limit)
+    : delta_document_limit_(delta_document_limit), segment_document_limit_(segment_document_limit) {
+    if (delta_document_limit_ == 0 || segment_document_limit_ < delta_document_limit_) {
+        throw std::invalid_argument("Segment limits must be positive and segments not smaller than the delta");
+    }
+    Segments segments;
+    if (static_cast<size_t>(search_server.GetDocumentCount()) < delta_document_limit_) {
+        segments.push_back(std::make_shared<const SearchServer>(std::move(search_server)));
+    } else {
+        AppendSegments(segments, search_server);
+        segments.push_back(std::make_shared<const SearchServer>(search_server.CreateEmpty()));
+    }
+    current_.store(std::make_shared<const Snapshot>(std::move(segments), 0), std::memory_order_release);
+}
+
+
+std::shared_ptr<const ConcurrentSearchServer::Snapshot> ConcurrentSearchServer::GetSnapshot() const {
+    return current_.load(std::memory_order_acquire);
+}
+
+
+std::uint64_t ConcurrentSearchServer::GetGeneration() const {
+    return GetSnapshot()->GetGeneration();
+}
+
+
+std::tuple<std::vector<std::string>, DocumentStatus> ConcurrentSearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+    const std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    const auto [matched_words, status] = snapshot->MatchDocument(raw_query, document_id);
+    return { std::vector<std::string>(matched_words.begin(), matched_words.end()), status };
+}
+
+
+int ConcurrentSearchServer::GetDocumentCount() const {
+    return GetSnapshot()->GetDocumentCount();
+}
+
+
+void ConcurrentSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    AddDocuments({ RawDocument{ document_id, document, status, ratings } });
+}
+
+
+void ConcurrentSearchServer::AddDocuments(const std::vector<RawDocument>& documents) {
+    if (documents.empty()) {
+        return;
+    }
+    std::lock_guard write_guard(write_mutex_);
+    Segments segments = GetSnapshot()->segments_;
+    const SearchServer& delta = *segments.back();
+
+    // Пачки не длиннее сегмента, чтобы крупный вызов не создал сегмент, удаление из которого дорого
+    std::vector<SearchServer::PreparedDocuments> batches;
+    for (size_t begin = 0; begin < documents.size(); begin += segment_document_limit_) {
+        const size_t count = std::min(segment_document_limit_, documents.size() - begin);
+        batches.push_back(delta.PrepareDocuments(std::span(documents).subspan(begin, count)));
+    }
+
+    // Проверка в исходном порядке документов, чтобы ошибка была той же, что у SearchServer
+    std::unordered_set<int> batch_ids;
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const int document_id = documents[i].id;
+        if (std::any_of(segments.begin(), segments.end() - 1,
+                        [document_id](const auto& segment) { return segment->document_ordinals_.contains(document_id); })) {
+            throw std::invalid_argument("Document with this ID already added");
+        }
+        delta.CheckPreparedDocument(batches[i / segment_document_limit_], i % segment_document_limit_, batch_ids);
+    }
+
+    // Небольшая пачка дописывается в копию дельты, которая запечатывается, когда заполнится.
+    // Крупная пачка сразу образует запечатанные сегменты.
+    SearchServer empty_delta = delta.CreateEmpty();
+    if (documents.size() < delta_document_limit_) {
+        auto next_delta = std::make_shared<SearchServer>(delta);
+        next_delta->AddPreparedDocuments(std::move(batches));
+        const bool is_full = static_cast<size_t>(next_delta->GetDocumentCount()) >= delta_document_limit_;
+        segments.back() = std::move(next_delta);
+        if (!is_full) {
+            Publish(std::move(segments));
+            return;
+        }
+        MergeSealedSegments(segments);
+    } else {
+        if (delta.GetDocumentCount() == 0) {
+            segments.pop_back();
+        } else {
+            MergeSealedSegments(segments);
+        }
+        for (SearchServer::PreparedDocuments& batch : batches) {
+            auto segment = std::make_shared<SearchServer>(empty_delta.CreateEmpty());
+            std::vector<SearchServer::PreparedDocuments> segment_batches;
+            segment_batches.push_back(std::move(batch));
+            segment->AddPreparedDocuments(std::move(segment_batches));
+            segments.push_back(std::move(segment));
+            MergeSealedSegments(segments);
+        }
+    }
+    segments.push_back(std::make_shared<const SearchServer>(std::move(empty_delta)));
+    Publish(std::move(segments));
+}
+
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    std::lock_guard write_guard(write_mutex_);
+    Segments segments = GetSnapshot()->segments_;
+    const auto segment_it = std::find_if(segments.begin(), segments.end(),
+        [document_id](const auto& segment) { return segment->document_ordinals_.contains(document_id); });
+    if (segment_it == segments.end()) {
+        return;
+    }
+
+    // Копия сегмента еще не видна читателям, поэтому ее можно сжать, когда удаленных ординалов больше живых
+    auto segment = std::make_shared<SearchServer>(**segment_it);
+    segment->RemoveDocument(document_id);
+    if (segment->documents_.ids.size() > 2 * static_cast<size_t>(segment->GetDocumentCount())) {
+        segment->Compact();
+    }
+    if (segment->GetDocumentCount() == 0 && segment_it != segments.end() - 1) {
+        segments.erase(segment_it);
+    } else {
+        *segment_it = std::move(segment);
+    }
+    Publish(std::move(segments));
+}
+
+
+void ConcurrentSearchServer::AppendSegments(Segments& segments, const SearchServer& source) const {
+    const int ordinal_count = static_cast<int>(source.documents_.ids.size());
+    for (int first_ordinal = 0; first_ordinal < ordinal_count; first_ordinal += static_cast<int>(segment_document_limit_)) {
+        const int last_ordinal = std::min(ordinal_count, first_ordinal + static_cast<int>(segment_document_limit_));
+        std::vector<SearchServer::PreparedDocuments> batches;
+        batches.push_back(source.ExportDocuments(first_ordinal, last_ordinal));
+        if (batches.front().size() == 0) {
+            continue;
+        }
+        auto segment = std::make_shared<SearchServer>(source.CreateEmpty());
+        segment->AddPreparedDocuments(std::move(batches));
+        segments.push_back(std::move(segment));
+    }
+}
+
+
+void ConcurrentSearchServer::MergeSealedSegments(Segments& segments) const {
+    while (segments.size() >= 2) {
+        const SearchServer& previous = **(segments.end() - 2);
+        const SearchServer& last = *segments.back();
+        const size_t merged_count = static_cast<size_t>(previous.GetDocumentCount() + last.GetDocumentCount());
+        if (previous.GetDocumentCount() > last.GetDocumentCount() || merged_count > segment_document_limit_) {
+            return;
+        }
+        std::vector<SearchServer::PreparedDocuments> batches;
+        batches.push_back(previous.ExportDocuments(0, static_cast<int>(previous.documents_.ids.size())));
+        batches.push_back(last.ExportDocuments(0, static_cast<int>(last.documents_.ids.size())));
+        auto merged = std::make_shared<SearchServer>(previous.CreateEmpty());
+        merged->AddPreparedDocuments(std::move(batches));
+        segments.pop_back();
+        segments.back() = std::move(merged);
+    }
+}
+
+
+void ConcurrentSearchServer::Publish(Segments segments) {
+    // Предыдущее поколение освобождается здесь, если его не держит ни один читатель
+    const std::shared_ptr<const Snapshot> previous =
+        current_.exchange(std::make_shared<const Snapshot>(std::move(segments), GetGeneration() + 1), std::memory_order_acq_rel);
+}
\ No newline at end of file
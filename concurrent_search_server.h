@@ -0,0 +1,147 @@
+#pragma once
+#include "document.h"
+#include "partitioned_search.h"
+#include "search_server.h"
+
+#include <atomic>
+#include <cstdint>
+#include <execution>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Потокобезопасный индекс из неизменяемых сегментов. Последний сегмент - небольшая дельта, куда
+// попадают новые документы: запись копирует только ее. Заполненная дельта запечатывается, а соседние
+// запечатанные сегменты сливаются, пока не достигнут segment_document_limit документов, поэтому каждый
+// документ копируется O(log) раз, а удаление копирует лишь свой сегмент. Читатели закрепляют текущее
+// поколение - список сегментов - и не ждут писателей; старое поколение освобождается, когда его
+// отпустит последний читатель. Поиск идет по всем сегментам с IDF по всему корпусу, как у SearchServer.
+class ConcurrentSearchServer {
+public:
+    static constexpr size_t DEFAULT_DELTA_DOCUMENT_LIMIT = 128;
+    static constexpr size_t DEFAULT_SEGMENT_DOCUMENT_LIMIT = 16384;
+
+    // Неизменяемое поколение индекса
+    class Snapshot {
+    public:
+        Snapshot(std::vector<std::shared_ptr<const SearchServer>> segments, std::uint64_t generation);
+
+        template <DocumentPredicate PredicateFunc>
+        std::vector<Document> FindTopDocuments(std::string_view raw_query, PredicateFunc predicate_func,
+                                               size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+        std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                               size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+        std::vector<Document> FindTopDocuments(std::string_view raw_query, size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+        // policy задает, как обходятся сегменты
+        template <ExecutionPolicyType ExecutionPolicy, DocumentPredicate PredicateFunc>
+        std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, PredicateFunc predicate_func,
+                                               size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+        template <ExecutionPolicyType ExecutionPolicy>
+        std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+                                               size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+        template <ExecutionPolicyType ExecutionPolicy>
+        std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                               size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+        // Строки принадлежат словарю сегмента документа и живут, пока жив снимок
+        std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+        int GetDocumentCount() const;
+
+        size_t GetSegmentCount() const;
+
+        std::uint64_t GetGeneration() const;
+
+    private:
+        friend class ConcurrentSearchServer;
+
+        std::vector<std::shared_ptr<const SearchServer>> segments_;
+        std::vector<const SearchServer*> segment_pointers_;
+        std::uint64_t generation_;
+    };
+
+    explicit ConcurrentSearchServer(SearchServer search_server, size_t delta_document_limit = DEFAULT_DELTA_DOCUMENT_LIMIT,
+                                    size_t segment_document_limit = DEFAULT_SEGMENT_DOCUMENT_LIMIT);
+
+    std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+    std::uint64_t GetGeneration() const;
+
+    template <typename... Args>
+    std::vector<Document> FindTopDocuments(Args&&... args) const;
+
+    // Слова копируются: поколение, в словаре которого лежат строки, может быть освобождено сразу
+    // после возврата. Для разбора без копий следует держать GetSnapshot() и вызывать его MatchDocument.
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    int GetDocumentCount() const;
+
+    // Проверки и гарантии те же, что у SearchServer: при ошибке новое поколение не публикуется
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    void AddDocuments(const std::vector<RawDocument>& documents);
+
+    // Неизвестный ID игнорируется и не создает нового поколения
+    void RemoveDocument(int document_id);
+
+private:
+    using Segments = std::vector<std::shared_ptr<const SearchServer>>;
+
+    size_t delta_document_limit_;
+    size_t segment_document_limit_;
+    // Читатели закрепляют поколение атомарной загрузкой указателя, писатель публикует его атомарной заменой
+    std::atomic<std::shared_ptr<const Snapshot>> current_;
+    std::mutex write_mutex_;
+
+    // Запечатанные сегменты не длиннее segment_document_limit_ из документов source
+    void AppendSegments(Segments& segments, const SearchServer& source) const;
+
+    // Сливает последние запечатанные сегменты, пока предпоследний не больше последнего
+    void MergeSealedSegments(Segments& segments) const;
+
+    void Publish(Segments segments);
+};
+
+
+template <DocumentPredicate PredicateFunc>
+std::vector<Document> ConcurrentSearchServer::Snapshot::FindTopDocuments(std::string_view raw_query, PredicateFunc predicate_func,
+                                                                         size_t result_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, predicate_func, result_count);
+}
+
+
+template <ExecutionPolicyType ExecutionPolicy, DocumentPredicate PredicateFunc>
+std::vector<Document> ConcurrentSearchServer::Snapshot::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                                                         PredicateFunc predicate_func, size_t result_count) const {
+    return PartitionedSearch(segment_pointers_).FindTopDocuments(policy, raw_query, predicate_func, result_count);
+}
+
+
+template <ExecutionPolicyType ExecutionPolicy>
+std::vector<Document> ConcurrentSearchServer::Snapshot::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                                                         DocumentStatus status, size_t result_count) const {
+    return PartitionedSearch(segment_pointers_).FindTopDocuments(policy, raw_query, status, result_count);
+}
+
+
+template <ExecutionPolicyType ExecutionPolicy>
+std::vector<Document> ConcurrentSearchServer::Snapshot::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                                                         size_t result_count) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL, result_count);
+}
+
+
+template <typename... Args>
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(Args&&... args) const {
+    const std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    return snapshot->FindTopDocuments(std::forward<Args>(args)...);
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "corpus_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+ZipfDistribution::ZipfDistribution(int size, double exponent) {
+    if (size <= 0) {
+        throw std::invalid_argument("Zipf distribution must have at least one rank");
+    }
+    cumulative_weights_.reserve(size);
+    double sum = 0.0;
+    for (int rank = 1; rank <= size; ++rank) {
+        sum += 1.0 / std::pow(rank, exponent);
+        cumulative_weights_.push_back(sum);
+    }
+}
+
+
+int ZipfDistribution::Sample(double value) const {
+    const auto weight_it = std::upper_bound(cumulative_weights_.begin(), cumulative_weights_.end(), value);
+    return static_cast<int>(std::min(weight_it - cumulative_weights_.begin(), static_cast<std::ptrdiff_t>(cumulative_weights_.size()) - 1));
+}
+
+
+CorpusGenerator::CorpusGenerator(const CorpusConfig& config)
+    : config_(config), generator_(config.seed), word_distribution_(config.vocabulary_size, config.zipf_exponent) {
+    if (config.stop_word_count <= 0 && config.stop_word_ratio > 0.0) {
+        throw std::invalid_argument("Stop word ratio requires at least one stop word");
+    }
+    stop_words_.reserve(config.stop_word_count);
+    for (int i = 0; i < config.stop_word_count; ++i) {
+        stop_words_.push_back("stop" + std::to_string(i));
+    }
+}
+
+
+std::string CorpusGenerator::GetStopWordsText() const {
+    std::string text;
+    for (const std::string& stop_word : stop_words_) {
+        if (!text.empty()) {
+            text.push_back(' ');
+        }
+        text += stop_word;
+    }
+    return text;
+}
+
+
+std::string CorpusGenerator::GenerateDocument() {
+    std::bernoulli_distribution is_stop_word(config_.stop_word_ratio);
+    std::string document;
+    for (int i = 0; i < config_.document_length; ++i) {
+        if (i > 0) {
+            document.push_back(' ');
+        }
+        document += is_stop_word(generator_) ? GenerateStopWord() : MakeWord(word_distribution_(generator_));
+    }
+    return document;
+}
+
+
+std::string CorpusGenerator::GenerateQuery() {
+    std::bernoulli_distribution is_stop_word(config_.stop_word_ratio);
+    std::bernoulli_distribution is_minus_word(config_.minus_word_ratio);
+    std::string query;
+    for (int i = 0; i < config_.query_length; ++i) {
+        if (i > 0) {
+            query.push_back(' ');
+        }
+        if (is_stop_word(generator_)) {
+            query += GenerateStopWord();
+            continue;
+        }
+        if (is_minus_word(generator_)) {
+            query.push_back('-');
+        }
+        query += MakeWord(word_distribution_(generator_));
+    }
+    return query;
+}
+
+
+// Слово ранга rank - запись ранга в 26-ричной системе буквами: разные ранги дают разные слова,
+// а стоп-слова содержат цифры и с ними не совпадают
+std::string CorpusGenerator::MakeWord(int rank) {
+    std::string word;
+    do {
+        word.push_back(static_cast<char>('a' + rank % 26));
+        rank /= 26;
+    } while (rank > 0);
+    return word;
+}
+
+
+const std::string& CorpusGenerator::GenerateStopWord() {
+    return stop_words_[std::uniform_int_distribution<size_t>(0, stop_words_.size() - 1)(generator_)];
+}
\ No newline at end of file
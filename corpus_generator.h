@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+struct CorpusConfig {
+    int vocabulary_size = 50'000;
+    int document_count = 20'000;
+    int document_length = 40;
+    int query_count = 2'000;
+    int query_length = 3;
+    // Показатель степени распределения Ципфа: частота слова ранга r пропорциональна 1 / r^s
+    double zipf_exponent = 1.0;
+    int stop_word_count = 20;
+    // Доля стоп-слов среди слов документа и запроса
+    double stop_word_ratio = 0.2;
+    // Доля минус-слов среди слов запроса, не являющихся стоп-словами
+    double minus_word_ratio = 0.1;
+    std::uint32_t seed = 42;
+};
+
+// Дискретное распределение Ципфа на рангах [0, size): выборка - двоичный поиск по накопленным весам
+class ZipfDistribution {
+public:
+    ZipfDistribution(int size, double exponent);
+
+    template <typename Generator>
+    int operator()(Generator& generator) {
+        const double value = std::uniform_real_distribution<double>(0.0, cumulative_weights_.back())(generator);
+        return Sample(value);
+    }
+
+private:
+    std::vector<double> cumulative_weights_;
+
+    int Sample(double value) const;
+};
+
+// Детерминированный генератор корпуса: при одинаковой конфигурации выдает одни и те же
+// документы и запросы, поэтому результаты разных версий сервера сравнимы между собой
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(const CorpusConfig& config);
+
+    const std::vector<std::string>& GetStopWords() const {
+        return stop_words_;
+    }
+
+    // Стоп-слова через пробел, в виде, который принимает конструктор SearchServer
+    std::string GetStopWordsText() const;
+
+    std::string GenerateDocument();
+
+    std::string GenerateQuery();
+
+private:
+    CorpusConfig config_;
+    std::mt19937 generator_;
+    ZipfDistribution word_distribution_;
+    std::vector<std::string> stop_words_;
+
+    static std::string MakeWord(int rank);
+
+    const std::string& GenerateStopWord();
+};
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "document_loader.h"
+
+#include "bounded_queue.h"
+#include "mapped_file.h"
+
+#include <charconv>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct FileChunk {
+    size_t offset = 0;
+    std::string_view text;
+    std::promise<SearchServer::PreparedDocuments> result;
+};
+
+[[noreturn]] void ThrowMalformedRecord(size_t offset, std::string_view reason) {
+    throw std::invalid_argument("Malformed document record at byte " + std::to_string(offset) + ": " + std::string(reason));
+}
+
+std::string_view CutField(std::string_view& line, size_t offset) {
+    const size_t tab = line.find('\t');
+    if (tab == std::string_view::npos) {
+        ThrowMalformedRecord(offset, "expected id, status, ratings and text separated by tabs");
+    }
+    const std::string_view field = line.substr(0, tab);
+    line.remove_prefix(tab + 1);
+    return field;
+}
+
+int ParseNumber(std::string_view text, size_t offset) {
+    int value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size() || text.empty()) {
+        ThrowMalformedRecord(offset, "invalid number '" + std::string(text) + "'");
+    }
+    return value;
+}
+
+DocumentStatus ParseStatus(std::string_view text, size_t offset) {
+    if (text == "ACTUAL") {
+        return DocumentStatus::ACTUAL;
+    }
+    if (text == "IRRELEVANT") {
+        return DocumentStatus::IRRELEVANT;
+    }
+    if (text == "BANNED") {
+        return DocumentStatus::BANNED;
+    }
+    if (text == "REMOVED") {
+        return DocumentStatus::REMOVED;
+    }
+    ThrowMalformedRecord(offset, "unknown status '" + std::string(text) + "'");
+}
+
+RawDocument ParseRecord(std::string_view line, size_t offset) {
+    RawDocument document;
+    document.id = ParseNumber(CutField(line, offset), offset);
+    document.status = ParseStatus(CutField(line, offset), offset);
+    std::string_view ratings = CutField(line, offset);
+    while (!ratings.empty()) {
+        const size_t space = std::min(ratings.find(' '), ratings.size());
+        if (space > 0) {
+            document.ratings.push_back(ParseNumber(ratings.substr(0, space), offset));
+        }
+        ratings.remove_prefix(std::min(space + 1, ratings.size()));
+    }
+    document.content = line;
+    return document;
+}
+
+std::vector<RawDocument> ParseChunk(const FileChunk& chunk) {
+    std::vector<RawDocument> documents;
+    std::string_view text = chunk.text;
+    while (!text.empty()) {
+        const size_t line_end = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, line_end);
+        const size_t offset = chunk.offset + static_cast<size_t>(line.data() - chunk.text.data());
+        text.remove_prefix(std::min(line_end + 1, text.size()));
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            documents.push_back(ParseRecord(line, offset));
+        }
+    }
+    return documents;
+}
+
+}  // namespace
+
+
+LoadStats LoadDocuments(SearchServer& search_server, const std::string& path, const DocumentLoaderConfig& config) {
+    if (config.chunk_size == 0 || config.worker_count == 0 || config.chunks_in_flight == 0) {
+        throw std::invalid_argument("Chunk size, worker count and chunks in flight must be positive");
+    }
+
+    const MappedFile file(path);
+    const std::string_view data(reinterpret_cast<const char*>(file.GetData().data()), file.GetData().size());
+
+    // Результаты выстроены в порядке файла: производитель кладет сюда future части раньше,
+    // чем саму часть в очередь работ, и блокируется, когда несмерженных частей слишком много
+    BoundedQueue<FileChunk> chunks(config.chunks_in_flight);
+    BoundedQueue<std::future<SearchServer::PreparedDocuments>> results(config.chunks_in_flight);
+
+    // Потоки объявлены после очередей: при выходе они завершаются и присоединяются раньше, чем очереди разрушаются
+    std::vector<std::jthread> threads;
+    threads.reserve(config.worker_count + 1);
+    const auto close_queues = [&chunks, &results] {
+        chunks.Close();
+        results.Close();
+    };
+
+    LoadStats stats;
+    stats.byte_count = data.size();
+    try {
+        threads.emplace_back([&data, &chunks, &results, &config] {
+            size_t offset = 0;
+            while (offset < data.size()) {
+                size_t end = std::min(offset + config.chunk_size, data.size());
+                end = std::min(data.find('\n', end - 1), data.size() - 1) + 1;
+                FileChunk chunk{ offset, data.substr(offset, end - offset), {} };
+                if (!results.Push(chunk.result.get_future()) || !chunks.Push(std::move(chunk))) {
+                    return;
+                }
+                offset = end;
+            }
+            chunks.Close();
+            results.Close();
+        });
+        for (size_t i = 0; i < config.worker_count; ++i) {
+            threads.emplace_back([&search_server, &chunks] {
+                while (std::optional<FileChunk> chunk = chunks.Pop()) {
+                    try {
+                        const std::vector<RawDocument> documents = ParseChunk(*chunk);
+                        chunk->result.set_value(search_server.PrepareDocuments(documents));
+                    } catch (...) {
+                        chunk->result.set_exception(std::current_exception());
+                    }
+                }
+            });
+        }
+
+        // Единственная стадия, изменяющая индекс. Слияние обходит все затронутые списки документов,
+        // поэтому уже готовые к этому моменту части сливаются вместе за один проход.
+        std::optional<std::future<SearchServer::PreparedDocuments>> next_result = results.Pop();
+        while (next_result) {
+            std::vector<SearchServer::PreparedDocuments> batches;
+            do {
+                batches.push_back(next_result->get());
+                stats.document_count += batches.back().size();
+                next_result = batches.size() < config.chunks_in_flight ? results.TryPop() : std::nullopt;
+            } while (next_result && next_result->wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+            search_server.AddPreparedDocuments(std::move(batches));
+            if (!next_result) {
+                next_result = results.Pop();
+            }
+        }
+    } catch (...) {
+        close_queues();
+        throw;
+    }
+    return stats;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "search_server.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+// Формат файла: по документу в строке, поля разделены табуляцией:
+//   ID  статус (ACTUAL, IRRELEVANT, BANNED, REMOVED)  рейтинги через пробел  текст
+// Пустые строки пропускаются, завершающий \r отбрасывается.
+struct DocumentLoaderConfig {
+    // Файл режется на части примерно такого размера по границам строк
+    size_t chunk_size = 4 * 1024 * 1024;
+    size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+    // Сколько частей одновременно читается, разбирается и ждет слияния
+    size_t chunks_in_flight = 8;
+};
+
+struct LoadStats {
+    size_t document_count = 0;
+    size_t byte_count = 0;
+};
+
+// Конвейер: файл отображается в память, поток-производитель режет его на части, рабочие потоки
+// разбирают записи и слова (SearchServer::PrepareDocuments), а вызывающий поток сливает части
+// в индекс строго в порядке файла. Стадии связаны очередями ограниченной емкости, поэтому
+// в памяти одновременно не больше chunks_in_flight частей.
+// При ошибке в записи или документе выбрасывается исключение. Файл добавляется не атомарно:
+// документы частей, слитых до ошибки, остаются в индексе.
+LoadStats LoadDocuments(SearchServer& search_server, const std::string& path, const DocumentLoaderConfig& config = {});
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+
+void LatencyHistogram::Record(std::chrono::nanoseconds duration) {
+    const std::uint64_t value = duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0;
+    buckets_[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+std::uint64_t LatencyHistogram::GetCount() const {
+    std::uint64_t count = 0;
+    for (const std::atomic<std::uint64_t>& bucket : buckets_) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+
+std::chrono::nanoseconds LatencyHistogram::GetPercentile(double percentile) const {
+    std::array<std::uint64_t, BUCKET_COUNT> counts;
+    std::uint64_t total_count = 0;
+    for (size_t index = 0; index < BUCKET_COUNT; ++index) {
+        counts[index] = buckets_[index].load(std::memory_order_relaxed);
+        total_count += counts[index];
+    }
+    if (total_count == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percentile * total_count)));
+    std::uint64_t seen_count = 0;
+    for (size_t index = 0; index < BUCKET_COUNT; ++index) {
+        seen_count += counts[index];
+        if (seen_count >= rank) {
+            return std::chrono::nanoseconds(GetBucketUpperBound(index));
+        }
+    }
+    return std::chrono::nanoseconds(GetBucketUpperBound(BUCKET_COUNT - 1));
+}
+
+
+// Значения меньше SUB_BUCKET_COUNT хранятся точно; дальше номер корзины составляется из
+// старшего бита значения и следующих за ним SUB_BUCKET_BITS бит
+size_t LatencyHistogram::GetBucketIndex(std::uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+    const int exponent = std::bit_width(value) - 1;
+    const int shift = exponent - SUB_BUCKET_BITS;
+    const std::uint64_t sub_bucket = (value >> shift) & (SUB_BUCKET_COUNT - 1);
+    return static_cast<size_t>(shift + 1) * SUB_BUCKET_COUNT + static_cast<size_t>(sub_bucket);
+}
+
+
+std::uint64_t LatencyHistogram::GetBucketUpperBound(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    const int shift = static_cast<int>(index / SUB_BUCKET_COUNT) - 1;
+    const std::uint64_t sub_bucket = index % SUB_BUCKET_COUNT;
+    const std::uint64_t lower_bound = (SUB_BUCKET_COUNT + sub_bucket) << shift;
+    return lower_bound + ((std::uint64_t{1} << shift) - 1);
+}
\ No newline at end of file
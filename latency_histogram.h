@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Потокобезопасная гистограмма длительностей в наносекундах с логарифмически-линейными
+// корзинами: каждая степень двойки делится на SUB_BUCKET_COUNT равных частей, поэтому
+// относительная погрешность перцентилей не больше 1 / SUB_BUCKET_COUNT. Запись - одно
+// атомарное увеличение счетчика без блокировок.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    void Record(std::chrono::nanoseconds duration);
+
+    std::uint64_t GetCount() const;
+
+    // Верхняя граница корзины, в которую попадает доля percentile (от 0 до 1) записей;
+    // для пустой гистограммы - ноль
+    std::chrono::nanoseconds GetPercentile(double percentile) const;
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_{};
+
+    static size_t GetBucketIndex(std::uint64_t value);
+
+    static std::uint64_t GetBucketUpperBound(size_t index);
+};
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "live_ordinals.h"
+
+#include <bit>
+
+
+void LiveOrdinals::Append() {
+    const int position = static_cast<int>(tree_.size()) + 1;
+    const int range_begin = position - (position & -position);
+    tree_.push_back(1 + CountPrefix(position - 1) - CountPrefix(range_begin));
+    ++live_count_;
+}
+
+
+void LiveOrdinals::Remove(int ordinal) {
+    for (int position = ordinal + 1; position <= static_cast<int>(tree_.size()); position += position & -position) {
+        --tree_[position - 1];
+    }
+    --live_count_;
+}
+
+
+// Спуск по дереву: ищется наибольшая позиция, до которой живых не больше index
+int LiveOrdinals::FindOrdinal(int index) const {
+    int position = 0;
+    int remaining = index + 1;
+    for (int step = static_cast<int>(std::bit_floor(tree_.size())); step > 0; step /= 2) {
+        if (position + step <= static_cast<int>(tree_.size()) && tree_[position + step - 1] < remaining) {
+            position += step;
+            remaining -= tree_[position - 1];
+        }
+    }
+    return position;
+}
+
+
+int LiveOrdinals::CountPrefix(int size) const {
+    int count = 0;
+    for (int position = size; position > 0; position -= position & -position) {
+        count += tree_[position - 1];
+    }
+    return count;
+}
\ No newline at end of file
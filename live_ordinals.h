@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Живые ординалы документов в порядке добавления. Дерево Фенвика над признаками "ординал жив"
+// находит index-й живой ординал и снимает ординал за O(log n), поэтому удаление документа
+// не сдвигает массив, как при хранении списка ID.
+class LiveOrdinals {
+public:
+    // Добавляет следующий по порядку ординал живым
+    void Append();
+
+    // Ординал должен быть жив
+    void Remove(int ordinal);
+
+    // Ординал index-го по порядку живого документа; index < GetLiveCount()
+    int FindOrdinal(int index) const;
+
+    int GetLiveCount() const {
+        return live_count_;
+    }
+
+    std::size_t GetMemoryUsage() const {
+        return tree_.capacity() * sizeof(int);
+    }
+
+private:
+    // tree_[i - 1] - число живых ординалов в (i - lowbit(i), i], нумерация с единицы
+    std::vector<int> tree_;
+    int live_count_ = 0;
+
+    int CountPrefix(int size) const;
+};
\ No newline at end of file
@@ -1,18 +1,43 @@
+#include "benchmark_suite.h"
 #include "document.h"
 #include "paginator.h"
 #include "request_queue.h"
 #include "search_server.h"
+#include "search_server_benchmark.h"
 #include "search_server_test.h"
+#include "trace_hooks.h"
 
+#include <chrono>
 #include <iostream>
+#include <string_view>
+#include <vector>
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Вывод в stdout - одна строка JSON, параметры корпуса задаются как ключ=значение.
+    // Тесты перед замерами не запускаются: они печатают в stdout и испортили бы вывод.
+    if (argc > 1 && argv[1] == "--benchmark-suite"sv) {
+        RunBenchmarkSuite(ParseCorpusConfig(vector<string_view>(argv + 2, argv + argc)), std::cout);
+        return 0;
+    }
+
     TestSearchServer();
-    
+
+    if (argc > 1 && argv[1] == "--benchmark"sv) {
+        BenchmarkSearchServer();
+        if (TRACING_ENABLED) {
+            PrintTraceStats(std::cerr);
+        }
+        return 0;
+    }
+
+
     SearchServer search_server("and in at"s);
-    RequestQueue request_queue(search_server);
+    // Время в примере условное: каждый запрос приходит через минуту после предыдущего
+    int minute = 0;
+    RequestQueue request_queue(search_server, RequestQueue::DEFAULT_WINDOW,
+                               [&minute] { return RequestQueue::Clock::time_point(chrono::minutes(minute)); });
     search_server.AddDocument(1, "curly cat curly tail", DocumentStatus::ACTUAL, {7, 2, 7});
     search_server.AddDocument(2, "curly dog and fancy collar", DocumentStatus::ACTUAL, {1, 2, 3});
     search_server.AddDocument(3, "big cat fancy collar ", DocumentStatus::ACTUAL, {1, 2, 8});
@@ -20,13 +45,17 @@ int main() {
     search_server.AddDocument(5, "big dog sparrow Vasiliy", DocumentStatus::ACTUAL, {1, 1, 1});
     // 1439 запросов с нулевым результатом
     for (int i = 0; i < 1439; ++i) {
+        ++minute;
         request_queue.AddFindRequest("empty request");
     }
     // все еще 1439 запросов с нулевым результатом
+    ++minute;
     request_queue.AddFindRequest("curly dog");
     // новые сутки, первый запрос удален, 1438 запросов с нулевым результатом
+    ++minute;
     request_queue.AddFindRequest("big collar");
     // первый запрос удален, 1437 запросов с нулевым результатом
+    ++minute;
     request_queue.AddFindRequest("sparrow");
     std::cout << "Total empty requests: " << request_queue.GetNoResultRequests() << std::endl;
     return 0;
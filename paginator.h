@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <iterator>
-#include <vector>
+#include <stdexcept>
+#include <type_traits>
 
 template <typename Iterator>
 class IteratorRange {
@@ -31,33 +33,106 @@ private:
     Iterator end_;
 };
 
+// Страницы не хранятся, а вычисляются при обходе: границы следующей страницы находятся
+// при переходе к ней, поэтому создание пагинатора не выделяет память. Для итераторов
+// произвольного доступа size() и GetPage() работают за O(1).
 template <typename Iterator>
 class Paginator {
 public:
-    Paginator(Iterator begin, Iterator end, size_t size) {
-        while (std::distance(begin, end) >= size) {
-            pages_.push_back({ begin, begin + size, size });
-            std::advance(begin, size);
+    class PageIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IteratorRange<Iterator>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = IteratorRange<Iterator>;
+
+        PageIterator() = default;
+
+        IteratorRange<Iterator> operator*() const {
+            return { page_begin_, page_end_, page_size_ };
+        }
+
+        PageIterator& operator++() {
+            page_begin_ = page_end_;
+            page_size_ = Advance(page_end_, end_, max_page_size_);
+            return *this;
+        }
+
+        PageIterator operator++(int) {
+            PageIterator old = *this;
+            ++*this;
+            return old;
         }
-        if (begin != end) {
-            pages_.push_back({ begin, end, static_cast<size_t>(std::distance(end, begin)) });
+
+        bool operator==(const PageIterator& other) const {
+            return page_begin_ == other.page_begin_;
+        }
+
+    private:
+        friend class Paginator;
+
+        Iterator page_begin_;
+        Iterator page_end_;
+        Iterator end_;
+        size_t page_size_ = 0;
+        size_t max_page_size_ = 0;
+
+        PageIterator(Iterator page_begin, Iterator end, size_t max_page_size)
+            : page_begin_(page_begin), page_end_(page_begin), end_(end), max_page_size_(max_page_size) {
+            page_size_ = Advance(page_end_, end_, max_page_size_);
+        }
+    };
+
+    Paginator(Iterator begin, Iterator end, size_t page_size)
+        : begin_(begin), end_(end), page_size_(page_size) {
+        if (page_size == 0) {
+            throw std::invalid_argument("Page size must be positive");
         }
     }
 
-    auto begin() const {
-        return pages_.begin();
+    PageIterator begin() const {
+        return PageIterator(begin_, end_, page_size_);
     }
 
-    auto end() const {
-        return pages_.end();
+    PageIterator end() const {
+        return PageIterator(end_, end_, page_size_);
     }
 
     size_t size() const {
-        return pages_.size();
+        const size_t item_count = static_cast<size_t>(std::distance(begin_, end_));
+        return (item_count + page_size_ - 1) / page_size_;
+    }
+
+    // Страница с номером index от нуля; за последней страницей - пустая
+    IteratorRange<Iterator> GetPage(size_t index) const {
+        Iterator page_begin = begin_;
+        const size_t skipped_count = Advance(page_begin, end_, index * page_size_);
+        if (skipped_count < index * page_size_) {
+            return { end_, end_, 0 };
+        }
+        return *PageIterator(page_begin, end_, page_size_);
     }
 
 private:
-    std::vector<IteratorRange<Iterator>> pages_;
+    Iterator begin_;
+    Iterator end_;
+    size_t page_size_;
+
+    // Сдвигает it не более чем на count позиций, не выходя за end, и возвращает величину сдвига
+    static size_t Advance(Iterator& it, Iterator end, size_t count) {
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>) {
+            const size_t step = std::min(count, static_cast<size_t>(end - it));
+            it += step;
+            return step;
+        } else {
+            size_t step = 0;
+            for (; step < count && it != end; ++step) {
+                ++it;
+            }
+            return step;
+        }
+    }
 };
 
 template <typename Iterator>
@@ -0,0 +1,44 @@
+#include "partitioned_search.h"
+
+#include <cmath>
+
+
+int PartitionedSearch::GetDocumentCount() const {
+    int document_count = 0;
+    for (const SearchServer* part : parts_) {
+        document_count += part->GetDocumentCount();
+    }
+    return document_count;
+}
+
+
+const SearchServer* PartitionedSearch::FindPart(int document_id) const {
+    const auto part_it = std::find_if(parts_.begin(), parts_.end(),
+        [document_id](const SearchServer* part) { return part->document_ordinals_.contains(document_id); });
+    return part_it != parts_.end() ? *part_it : nullptr;
+}
+
+
+// Запрос разбирается один раз по стоп-словам первой части. IDF вычисляется тем же выражением,
+// что и в SearchServer, - разностью логарифмов числа документов и частоты слова, - чтобы совпасть
+// с неразбитым индексом бит в бит.
+SearchServer::QueryWords PartitionedSearch::ParseQuery(std::string_view raw_query, std::pmr::memory_resource* resource) const {
+    SearchServer::QueryWords query_words = parts_.front()->ParseQuery(raw_query, resource);
+    const int document_count = GetDocumentCount();
+    const double log_document_count = document_count > 0 ? std::log(static_cast<double>(document_count)) : 0.0;
+
+    query_words.plus_word_idfs.reserve(query_words.plus_words.size());
+    for (const std::string_view plus_word : query_words.plus_words) {
+        size_t document_frequency = 0;
+        for (const SearchServer* part : parts_) {
+            const int term_id = part->FindIndexedTerm(plus_word);
+            if (term_id != TermDictionary::NO_TERM) {
+                document_frequency += part->postings_[term_id].size();
+            }
+        }
+        const double log_document_frequency = document_frequency > 0 ? std::log(static_cast<double>(document_frequency)) : 0.0;
+        query_words.plus_word_idfs.push_back(log_document_count - log_document_frequency);
+    }
+
+    return query_words;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include "document.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <execution>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Поиск по индексу, разбитому на непересекающиеся части (шарды, сегменты). Каждая часть отдает
+// свой топ, и топы сливаются в общий. IDF плюс-слов считается по всему корпусу - суммарному числу
+// документов и частотам слова во всех частях, - поэтому релевантность и выдача совпадают с одним
+// SearchServer на тех же документах. Стоп-слова у частей должны быть общими.
+class PartitionedSearch {
+public:
+    // Части не копируются и должны жить дольше объекта; список не пуст
+    explicit PartitionedSearch(std::span<const SearchServer* const> parts)
+        : parts_(parts) {}
+
+    // policy задает, как обходятся части; внутри части поиск последовательный
+    template <ExecutionPolicyType ExecutionPolicy, DocumentPredicate PredicateFunc>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, PredicateFunc predicate_func,
+                                           size_t result_count) const;
+
+    template <ExecutionPolicyType ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+                                           size_t result_count) const;
+
+    int GetDocumentCount() const;
+
+    // Часть, в которой хранится документ, или nullptr
+    const SearchServer* FindPart(int document_id) const;
+
+private:
+    std::span<const SearchServer* const> parts_;
+
+    SearchServer::QueryWords ParseQuery(std::string_view raw_query, std::pmr::memory_resource* resource) const;
+
+    // make_filter строит для части фильтр ординалов ее документов
+    template <typename ExecutionPolicy, typename MakeFilter>
+    std::vector<Document> FindTopDocumentsOnParts(ExecutionPolicy&& policy, const SearchServer::QueryWords& query_words,
+                                                  MakeFilter make_filter, size_t result_count) const;
+};
+
+
+template <ExecutionPolicyType ExecutionPolicy, DocumentPredicate PredicateFunc>
+std::vector<Document> PartitionedSearch::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, PredicateFunc predicate_func,
+                                                          size_t result_count) const {
+    const QueryArena::Scope query_arena;
+    return FindTopDocumentsOnParts(policy, ParseQuery(raw_query, query_arena.GetResource()),
+                                   [&predicate_func](const SearchServer& part) { return part.MakePredicateFilter(predicate_func); },
+                                   result_count);
+}
+
+
+template <ExecutionPolicyType ExecutionPolicy>
+std::vector<Document> PartitionedSearch::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+                                                          size_t result_count) const {
+    const QueryArena::Scope query_arena;
+    return FindTopDocumentsOnParts(policy, ParseQuery(raw_query, query_arena.GetResource()),
+                                   [status](const SearchServer& part) { return part.MakeStatusFilter(status); }, result_count);
+}
+
+
+// Документ общего топа входит и в топ своей части, поэтому слияния топов частей достаточно
+template <typename ExecutionPolicy, typename MakeFilter>
+std::vector<Document> PartitionedSearch::FindTopDocumentsOnParts(ExecutionPolicy&& policy, const SearchServer::QueryWords& query_words,
+                                                                 MakeFilter make_filter, size_t result_count) const {
+    std::vector<std::vector<Document>> part_results(parts_.size());
+    std::transform(policy, parts_.begin(), parts_.end(), part_results.begin(),
+        [&query_words, &make_filter, result_count](const SearchServer* part) {
+            return part->FindTopDocumentsForQuery(std::execution::seq, query_words, make_filter(*part), result_count);
+        });
+
+    std::vector<Document> result;
+    for (const std::vector<Document>& part_result : part_results) {
+        result.insert(result.end(), part_result.begin(), part_result.end());
+    }
+    SearchServer::SelectTopDocuments(std::execution::seq, result, result_count);
+
+    return result;
+}
\ No newline at end of file
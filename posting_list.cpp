@@ -0,0 +1,280 @@
+#include "posting_list.h"
+
+#include <algorithm>
+
+namespace {
+
+void WriteVarint(std::vector<std::uint8_t>& bytes, std::uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint32_t ReadVarint(const std::uint8_t* bytes, std::size_t& offset) {
+    std::uint32_t value = 0;
+    int shift = 0;
+    while (bytes[offset] & 0x80) {
+        value |= static_cast<std::uint32_t>(bytes[offset++] & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<std::uint32_t>(bytes[offset++]) << shift;
+    return value;
+}
+
+// Как ReadVarint, но не выходит за границы bytes и отвергает числа длиннее 32 бит
+bool ReadVarintChecked(std::span<const std::uint8_t> bytes, std::size_t& offset, std::uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset >= bytes.size()) {
+            return false;
+        }
+        const std::uint8_t byte = bytes[offset++];
+        if (shift == 28 && byte > 0x0F) {
+            return false;
+        }
+        value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+
+PostingList::Iterator::Iterator(const PostingList* list, int index)
+    : bytes_(list->GetBytes().data()), skips_(list->GetSkips()), size_(list->size_), index_(index) {
+    if (index_ < size_) {
+        DecodeCurrent();
+        SkipRemoved();
+    }
+}
+
+
+PostingList::Iterator& PostingList::Iterator::operator++() {
+    Step();
+    SkipRemoved();
+    return *this;
+}
+
+
+void PostingList::Iterator::SkipTo(int document_id) {
+    if (index_ >= size_ || entry_.document_id >= document_id) {
+        return;
+    }
+
+    const auto current_block = skips_.begin() + index_ / BLOCK_SIZE;
+    const auto target_block = std::prev(std::upper_bound(current_block, skips_.end(), document_id,
+        [](int id, const SkipEntry& skip) { return id < skip.first_document_id; }));
+    if (target_block != current_block) {
+        index_ = static_cast<int>(target_block - skips_.begin()) * BLOCK_SIZE;
+        DecodeCurrent();
+    }
+    while (index_ < size_ && (entry_.term_count == 0 || entry_.document_id < document_id)) {
+        Step();
+    }
+}
+
+
+void PostingList::Iterator::DecodeCurrent() {
+    if (index_ % BLOCK_SIZE == 0) {
+        const SkipEntry& skip = skips_[index_ / BLOCK_SIZE];
+        entry_.document_id = skip.first_document_id;
+        offset_ = skip.offset;
+    } else {
+        entry_.document_id += static_cast<int>(ReadVarint(bytes_, offset_));
+    }
+    entry_.term_count = static_cast<int>(ReadVarint(bytes_, offset_));
+}
+
+
+void PostingList::Iterator::Step() {
+    ++index_;
+    if (index_ < size_) {
+        DecodeCurrent();
+    }
+}
+
+
+void PostingList::Iterator::SkipRemoved() {
+    while (index_ < size_ && entry_.term_count == 0) {
+        Step();
+    }
+}
+
+
+PostingList::PostingList(std::span<const std::uint8_t> bytes, std::span<const SkipEntry> skips, int size, int last_document_id)
+    : external_bytes_(bytes), external_skips_(skips), is_external_(true), size_(size), last_document_id_(last_document_id) {}
+
+
+bool PostingList::IsValid(std::span<const std::uint8_t> bytes, std::span<const SkipEntry> skips, int size, int last_document_id,
+                          int document_id_limit) {
+    if (size < 0 || skips.size() != static_cast<std::size_t>(size / BLOCK_SIZE + (size % BLOCK_SIZE != 0))) {
+        return false;
+    }
+
+    // Блоки записаны подряд, поэтому смещение блока совпадает с концом предыдущего
+    std::int64_t previous_document_id = -1;
+    std::size_t offset = 0;
+    for (int index = 0; index < size; ++index) {
+        std::int64_t document_id = 0;
+        if (index % BLOCK_SIZE == 0) {
+            const SkipEntry& skip = skips[index / BLOCK_SIZE];
+            if (skip.offset != offset) {
+                return false;
+            }
+            document_id = skip.first_document_id;
+        } else {
+            std::uint32_t delta = 0;
+            if (!ReadVarintChecked(bytes, offset, delta)) {
+                return false;
+            }
+            document_id = previous_document_id + delta;
+        }
+        std::uint32_t term_count = 0;
+        if (document_id <= previous_document_id || document_id >= document_id_limit || !ReadVarintChecked(bytes, offset, term_count)
+            || term_count == 0 || term_count > static_cast<std::uint32_t>(INT32_MAX)) {
+            return false;
+        }
+        previous_document_id = document_id;
+    }
+    return offset == bytes.size() && previous_document_id == last_document_id;
+}
+
+
+void PostingList::Add(int document_id, int term_count) {
+    if (document_id > last_document_id_) {
+        DetachExternal();
+        Append(document_id, term_count);
+        return;
+    }
+
+    std::vector<Entry> entries = Decode();
+    const auto entry_it = std::lower_bound(entries.begin(), entries.end(), document_id,
+        [](const Entry& entry, int id) { return entry.document_id < id; });
+    entries.insert(entry_it, { document_id, term_count });
+    Rebuild(entries);
+}
+
+
+void PostingList::AddEntries(std::span<const Entry> entries) {
+    if (entries.empty()) {
+        return;
+    }
+    if (entries.front().document_id > last_document_id_) {
+        DetachExternal();
+        for (const Entry& entry : entries) {
+            Append(entry.document_id, entry.term_count);
+        }
+        return;
+    }
+
+    const std::vector<Entry> current_entries = Decode();
+    std::vector<Entry> merged_entries;
+    merged_entries.reserve(current_entries.size() + entries.size());
+    std::merge(current_entries.begin(), current_entries.end(), entries.begin(), entries.end(), std::back_inserter(merged_entries),
+               [](const Entry& lhs, const Entry& rhs) { return lhs.document_id < rhs.document_id; });
+    Rebuild(merged_entries);
+}
+
+
+bool PostingList::Remove(int document_id) {
+    const std::span<const SkipEntry> skips = GetSkips();
+    const auto next_block = std::upper_bound(skips.begin(), skips.end(), document_id,
+        [](int id, const SkipEntry& skip) { return id < skip.first_document_id; });
+    if (next_block == skips.begin()) {
+        return false;
+    }
+
+    // Ищем запись в ее блоке и запоминаем положение и длину числа вхождений
+    const int block = static_cast<int>(next_block - skips.begin()) - 1;
+    const std::uint8_t* bytes = GetBytes().data();
+    std::size_t offset = skips[block].offset;
+    int current_document_id = skips[block].first_document_id;
+    std::size_t term_count_offset = 0;
+    std::uint32_t term_count = 0;
+    for (int index = block * BLOCK_SIZE; index < std::min(size_, (block + 1) * BLOCK_SIZE); ++index) {
+        if (index % BLOCK_SIZE != 0) {
+            current_document_id += static_cast<int>(ReadVarint(bytes, offset));
+        }
+        term_count_offset = offset;
+        term_count = ReadVarint(bytes, offset);
+        if (current_document_id >= document_id) {
+            break;
+        }
+    }
+    if (current_document_id != document_id || term_count == 0) {
+        return false;
+    }
+
+    // Ноль записывается с той же длиной, что и прежнее значение: 0x80 ... 0x80 0x00
+    DetachExternal();
+    for (std::size_t i = term_count_offset; i + 1 < offset; ++i) {
+        bytes_[i] = 0x80;
+    }
+    bytes_[offset - 1] = 0;
+    ++removed_count_;
+    if (removed_count_ * 4 > size_) {
+        Compact();
+    }
+    return true;
+}
+
+
+void PostingList::Compact() {
+    Rebuild(Decode());
+}
+
+
+std::size_t PostingList::GetMemoryUsage() const {
+    return sizeof(PostingList) + bytes_.capacity() + skips_.capacity() * sizeof(SkipEntry);
+}
+
+
+void PostingList::DetachExternal() {
+    if (!is_external_) {
+        return;
+    }
+    bytes_.assign(external_bytes_.begin(), external_bytes_.end());
+    skips_.assign(external_skips_.begin(), external_skips_.end());
+    external_bytes_ = {};
+    external_skips_ = {};
+    is_external_ = false;
+}
+
+
+void PostingList::Append(int document_id, int term_count) {
+    if (size_ % BLOCK_SIZE == 0) {
+        skips_.push_back({ document_id, static_cast<std::uint32_t>(bytes_.size()) });
+    } else {
+        WriteVarint(bytes_, static_cast<std::uint32_t>(document_id - last_document_id_));
+    }
+    WriteVarint(bytes_, static_cast<std::uint32_t>(term_count));
+    last_document_id_ = document_id;
+    ++size_;
+}
+
+
+void PostingList::Rebuild(const std::vector<Entry>& entries) {
+    external_bytes_ = {};
+    external_skips_ = {};
+    is_external_ = false;
+    bytes_.clear();
+    skips_.clear();
+    size_ = 0;
+    removed_count_ = 0;
+    last_document_id_ = -1;
+    for (const Entry& entry : entries) {
+        Append(entry.document_id, entry.term_count);
+    }
+    bytes_.shrink_to_fit();
+    skips_.shrink_to_fit();
+}
+
+
+std::vector<PostingList::Entry> PostingList::Decode() const {
+    return std::vector<Entry>(begin(), end());
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+// Сжатый список вхождений слова: ID документов по возрастанию, разности ID и число вхождений
+// кодируются varint. Каждые BLOCK_SIZE записей начинают блок, первый ID которого хранится
+// в таблице пропусков, что позволяет перескакивать вперед без декодирования.
+// Список может ссылаться на чужую память (отображенный снимок индекса); при первом
+// изменении он копирует данные к себе.
+// Удаление не перекодирует список: число вхождений записи заменяется нулем той же длины,
+// и итератор пропускает такие записи. Когда удаленных записей становится больше четверти,
+// список уплотняется.
+class PostingList {
+public:
+    static constexpr int BLOCK_SIZE = 64;
+
+    struct Entry {
+        int document_id = 0;
+        int term_count = 0;
+    };
+
+    struct SkipEntry {
+        std::int32_t first_document_id;
+        std::uint32_t offset;
+    };
+
+    PostingList() = default;
+
+    // Список поверх внешней памяти, которая должна жить дольше него
+    PostingList(std::span<const std::uint8_t> bytes, std::span<const SkipEntry> skips, int size, int last_document_id);
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry*;
+        using reference = const Entry&;
+
+        Iterator() = default;
+
+        const Entry& operator*() const {
+            return entry_;
+        }
+
+        const Entry* operator->() const {
+            return &entry_;
+        }
+
+        Iterator& operator++();
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        // Продвигает итератор к первой записи с ID документа не меньше document_id
+        void SkipTo(int document_id);
+
+        bool operator==(const Iterator& other) const {
+            return index_ == other.index_;
+        }
+
+    private:
+        friend class PostingList;
+
+        const std::uint8_t* bytes_ = nullptr;
+        std::span<const SkipEntry> skips_;
+        int size_ = 0;
+        int index_ = 0;
+        std::size_t offset_ = 0;
+        Entry entry_;
+
+        Iterator(const PostingList* list, int index);
+
+        void DecodeCurrent();
+
+        void Step();
+
+        void SkipRemoved();
+    };
+
+    void Add(int document_id, int term_count);
+
+    // Добавляет пачку записей, отсортированных по ID документа, за одно перекодирование
+    void AddEntries(std::span<const Entry> entries);
+
+    // Стоимость - поиск блока по таблице пропусков и разбор одного блока
+    bool Remove(int document_id);
+
+    // Перекодирует список без удаленных записей
+    void Compact();
+
+    // Проверяет внешние данные списка (например, из снимка) до построения списка над ними:
+    // число блоков, смещения блоков, возрастание ID, положительные числа вхождений и то, что все
+    // записи разбираются внутри bytes. ID документов должны быть меньше document_id_limit.
+    static bool IsValid(std::span<const std::uint8_t> bytes, std::span<const SkipEntry> skips, int size, int last_document_id,
+                        int document_id_limit);
+
+    bool HasRemovedEntries() const {
+        return removed_count_ > 0;
+    }
+
+    Iterator begin() const {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() const {
+        return Iterator(this, size_);
+    }
+
+    // Число записей без удаленных
+    std::size_t size() const {
+        return static_cast<std::size_t>(size_ - removed_count_);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    int GetLastDocumentId() const {
+        return last_document_id_;
+    }
+
+    std::span<const std::uint8_t> GetBytes() const {
+        return is_external_ ? external_bytes_ : std::span<const std::uint8_t>(bytes_);
+    }
+
+    std::span<const SkipEntry> GetSkips() const {
+        return is_external_ ? external_skips_ : std::span<const SkipEntry>(skips_);
+    }
+
+    // Учитывается только собственная память списка, внешние данные не входят
+    std::size_t GetMemoryUsage() const;
+
+private:
+    std::vector<std::uint8_t> bytes_;
+    std::vector<SkipEntry> skips_;
+    std::span<const std::uint8_t> external_bytes_;
+    std::span<const SkipEntry> external_skips_;
+    bool is_external_ = false;
+    // Закодированные записи вместе с удаленными
+    int size_ = 0;
+    int removed_count_ = 0;
+    int last_document_id_ = -1;
+
+    void DetachExternal();
+
+    void Append(int document_id, int term_count);
+
+    void Rebuild(const std::vector<Entry>& entries);
+
+    std::vector<Entry> Decode() const;
+};
\ No newline at end of file
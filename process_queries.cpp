@@ -0,0 +1,45 @@
+#include "process_queries.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <numeric>
+
+
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries) {
+    std::vector<std::vector<Document>> result(queries.size());
+    std::transform(std::execution::par, queries.begin(), queries.end(), result.begin(),
+        [&search_server](const std::string& query) { return search_server.FindTopDocuments(query); });
+
+    return result;
+}
+
+
+// Запрос возвращает не больше MAX_RESULT_DOCUMENT_COUNT документов, поэтому каждый пишет в свой
+// участок общего массива, а затем участки сдвигаются к началу по порядку запросов
+std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries) {
+    std::vector<Document> result(queries.size() * MAX_RESULT_DOCUMENT_COUNT);
+    std::vector<size_t> found_counts(queries.size());
+    std::vector<size_t> query_indexes(queries.size());
+    std::iota(query_indexes.begin(), query_indexes.end(), 0);
+    std::for_each(std::execution::par, query_indexes.begin(), query_indexes.end(),
+        [&search_server, &queries, &result, &found_counts](size_t query_index) {
+            const std::vector<Document> documents = search_server.FindTopDocuments(queries[query_index]);
+            std::copy(documents.begin(), documents.end(), result.begin() + query_index * MAX_RESULT_DOCUMENT_COUNT);
+            found_counts[query_index] = documents.size();
+        });
+
+    auto output = result.begin();
+    for (size_t query_index = 0; query_index < queries.size(); ++query_index) {
+        const auto slot = result.begin() + query_index * MAX_RESULT_DOCUMENT_COUNT;
+        // Пока все участки были полными, документы уже на своих местах
+        if (output == slot) {
+            output += static_cast<std::ptrdiff_t>(found_counts[query_index]);
+        } else {
+            output = std::move(slot, slot + found_counts[query_index], output);
+        }
+    }
+    result.erase(output, result.end());
+
+    return result;
+}
\ No newline at end of file
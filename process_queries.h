@@ -0,0 +1,10 @@
+#pragma once
+#include "document.h"
+#include "search_server.h"
+
+#include <string>
+#include <vector>
+
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries);
+
+std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries);
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "query_arena.h"
+
+#include <memory>
+
+namespace {
+
+// Буфер выделяется один раз при первом запросе в потоке; то, что в него не поместилось,
+// арена берет из кучи и отдает при сбросе
+struct ThreadArena {
+    std::unique_ptr<std::byte[]> buffer = std::make_unique<std::byte[]>(QueryArena::BUFFER_SIZE);
+    std::pmr::monotonic_buffer_resource resource{ buffer.get(), QueryArena::BUFFER_SIZE, std::pmr::new_delete_resource() };
+    int depth = 0;
+};
+
+thread_local ThreadArena thread_arena;
+
+} // namespace
+
+
+QueryArena::Scope::Scope()
+    : resource_(&thread_arena.resource) {
+    ++thread_arena.depth;
+}
+
+
+QueryArena::Scope::~Scope() {
+    if (--thread_arena.depth == 0) {
+        thread_arena.resource.release();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Арена для временных данных запроса: разобранных слов и рабочих массивов отбора топа.
+// У каждого потока своя монотонная арена поверх заранее выделенного буфера; выделение из нее -
+// сдвиг указателя, а вся память возвращается разом, когда закрывается внешняя из вложенных
+// областей Scope. Данные, размещенные в арене, не должны переживать свою область.
+class QueryArena {
+public:
+    static constexpr size_t BUFFER_SIZE = 32 * 1024;
+
+    class Scope {
+    public:
+        Scope();
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope();
+
+        std::pmr::memory_resource* GetResource() const {
+            return resource_;
+        }
+
+    private:
+        std::pmr::memory_resource* resource_;
+    };
+};
\ No newline at end of file
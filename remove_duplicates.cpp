@@ -0,0 +1,59 @@
+#include "remove_duplicates.h"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Слова документа по алфавиту; строки принадлежат словарю индекса
+std::vector<std::string_view> GetDocumentWords(const SearchServer& search_server, int document_id) {
+    std::vector<std::string_view> words;
+    for (const auto& [word, freq] : search_server.GetWordFrequencies(document_id)) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+size_t ComputeWordSetSignature(const std::vector<std::string_view>& words) {
+    std::hash<std::string_view> hasher;
+    size_t signature = words.size();
+    for (const std::string_view word : words) {
+        signature ^= hasher(word) + 0x9e3779b97f4a7c15ULL + (signature << 6) + (signature >> 2);
+    }
+    return signature;
+}
+
+} // namespace
+
+
+// Наборы слов оставленных документов хранятся по сигнатуре, поэтому при совпадении сигнатур
+// документ сравнивается с уже построенными наборами, а не перечитывает слова оставленных документов
+std::vector<int> RemoveDuplicates(SearchServer& search_server) {
+    std::vector<int> document_ids;
+    document_ids.reserve(search_server.GetDocumentCount());
+    for (int index = 0; index < search_server.GetDocumentCount(); ++index) {
+        document_ids.push_back(search_server.GetDocumentId(index));
+    }
+    std::sort(document_ids.begin(), document_ids.end());
+
+    std::unordered_map<size_t, std::vector<std::vector<std::string_view>>> kept_word_sets_by_signature;
+    std::vector<int> duplicate_ids;
+    for (const int document_id : document_ids) {
+        std::vector<std::string_view> words = GetDocumentWords(search_server, document_id);
+        std::vector<std::vector<std::string_view>>& kept_word_sets = kept_word_sets_by_signature[ComputeWordSetSignature(words)];
+        if (std::find(kept_word_sets.begin(), kept_word_sets.end(), words) != kept_word_sets.end()) {
+            duplicate_ids.push_back(document_id);
+        } else {
+            kept_word_sets.push_back(std::move(words));
+        }
+    }
+
+    for (const int document_id : duplicate_ids) {
+        search_server.RemoveDocument(document_id);
+    }
+
+    return duplicate_ids;
+}
\ No newline at end of file
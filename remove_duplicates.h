@@ -0,0 +1,8 @@
+#pragma once
+#include "search_server.h"
+
+#include <vector>
+
+// Удаляет документы с тем же набором слов, что и у документа с меньшим ID.
+// Возвращает ID удаленных документов по возрастанию.
+std::vector<int> RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
@@ -1,16 +1,57 @@
 #include "request_queue.h"
 
+#include <algorithm>
 
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentStatus status) {
-    return AddFindRequest(raw_query, [status](int document_id, DocumentStatus document_status, int rating) { return document_status == status; });
+
+RequestQueue::RequestQueue(const SearchServer& search_server, Clock::duration window, TimeSource now)
+    : search_server_(search_server),
+      now_(std::move(now)),
+      window_requests_(window, WINDOW_BUCKET_COUNT),
+      window_no_result_requests_(window, WINDOW_BUCKET_COUNT) {}
+
+
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query, DocumentStatus status) {
+    const Clock::time_point start_time = Clock::now();
+    std::vector<Document> result = search_server_.FindTopDocuments(raw_query, status);
+    RecordRequest(Clock::now() - start_time, result.size());
+
+    return result;
 }
 
 
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query) {
-    return AddFindRequest(raw_query, [](int document_id, DocumentStatus document_status, int rating) { return document_status == DocumentStatus::ACTUAL; });
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query) {
+    return AddFindRequest(raw_query, DocumentStatus::ACTUAL);
 }
 
 
 int RequestQueue::GetNoResultRequests() const {
-    return no_result_requests_;
+    return static_cast<int>(window_no_result_requests_.Get(now_()));
+}
+
+
+RequestStats RequestQueue::GetStats() const {
+    const Clock::time_point now = now_();
+    RequestStats stats;
+    stats.total_requests = total_requests_.load(std::memory_order_relaxed);
+    stats.window_requests = window_requests_.Get(now);
+    stats.window_no_result_requests = window_no_result_requests_.Get(now);
+    stats.latency_p50 = latencies_.GetPercentile(0.50);
+    stats.latency_p95 = latencies_.GetPercentile(0.95);
+    stats.latency_p99 = latencies_.GetPercentile(0.99);
+    for (const std::atomic<std::uint64_t>& result_count : result_counts_) {
+        stats.result_count_distribution.push_back(result_count.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+
+void RequestQueue::RecordRequest(Clock::duration latency, size_t result_count) {
+    const Clock::time_point now = now_();
+    total_requests_.fetch_add(1, std::memory_order_relaxed);
+    window_requests_.Add(now);
+    if (result_count == 0) {
+        window_no_result_requests_.Add(now);
+    }
+    latencies_.Record(latency);
+    result_counts_[std::min(result_count, result_counts_.size() - 1)].fetch_add(1, std::memory_order_relaxed);
 }
\ No newline at end of file
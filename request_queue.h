@@ -1,53 +1,71 @@
 #pragma once
 #include "document.h"
+#include "latency_histogram.h"
 #include "search_server.h"
+#include "sliding_window_counter.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
-#include <deque>
-#include <string>
+#include <functional>
+#include <string_view>
 #include <vector>
 
+struct RequestStats {
+    std::uint64_t total_requests = 0;
+    std::uint64_t window_requests = 0;
+    std::uint64_t window_no_result_requests = 0;
+    std::chrono::nanoseconds latency_p50{0};
+    std::chrono::nanoseconds latency_p95{0};
+    std::chrono::nanoseconds latency_p99{0};
+    // Элемент i - число запросов, вернувших i документов
+    std::vector<std::uint64_t> result_count_distribution;
+};
+
+// Очередь запросов со статистикой. Все счетчики атомарные, поэтому одну очередь можно
+// использовать из нескольких потоков. Окно пустых запросов скользит по времени: по умолчанию
+// это последние сутки по steady_clock, разбитые на поминутные корзины. Источник времени
+// окна можно подменить; длительность запросов всегда измеряется по steady_clock.
 class RequestQueue {
 public:
-    RequestQueue(const SearchServer& search_server) : search_server_(search_server) {}
+    using Clock = std::chrono::steady_clock;
+    using TimeSource = std::function<Clock::time_point()>;
+
+    static constexpr Clock::duration DEFAULT_WINDOW = std::chrono::hours(24);
+    static constexpr size_t WINDOW_BUCKET_COUNT = 1440;
+
+    RequestQueue(const SearchServer& search_server, Clock::duration window = DEFAULT_WINDOW, TimeSource now = Clock::now);
 
     template <typename DocumentPredicate>
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate);
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate);
 
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentStatus status);
 
-    std::vector<Document> AddFindRequest(const std::string& raw_query);
+    std::vector<Document> AddFindRequest(std::string_view raw_query);
 
     int GetNoResultRequests() const;
 
+    RequestStats GetStats() const;
+
 private:
-    struct QueryResult {
-        bool is_empty;
-        std::uint64_t time;
-    };
     const SearchServer& search_server_;
-    std::deque<QueryResult> requests_;
-    const static int min_in_day_ = 1440;
-    std::uint64_t cur_time_ = 1;
-    std::uint64_t no_result_requests_ = 0;
+    TimeSource now_;
+    std::atomic<std::uint64_t> total_requests_ = 0;
+    SlidingWindowCounter window_requests_;
+    SlidingWindowCounter window_no_result_requests_;
+    LatencyHistogram latencies_;
+    std::array<std::atomic<std::uint64_t>, MAX_RESULT_DOCUMENT_COUNT + 1> result_counts_{};
+
+    void RecordRequest(Clock::duration latency, size_t result_count);
 };
 
 
 template <typename DocumentPredicate>
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate) {
+    const Clock::time_point start_time = Clock::now();
     std::vector<Document> result = search_server_.FindTopDocuments(raw_query, document_predicate);
-
-    requests_.push_back({ result.empty(), cur_time_ });
-    if (result.empty()) {
-        ++no_result_requests_;
-    }
-    if (cur_time_ > min_in_day_) {
-        if (requests_.front().is_empty) {
-            --no_result_requests_;
-        }
-        requests_.pop_front();
-    }
-    ++cur_time_;
+    RecordRequest(Clock::now() - start_time, result.size());
 
     return result;
 }
\ No newline at end of file
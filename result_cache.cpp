@@ -0,0 +1,81 @@
+#include "result_cache.h"
+
+#include <utility>
+
+
+ResultCache::ResultCache(const ResultCache& other)
+    : capacity_(other.capacity_.load(std::memory_order_relaxed)) {}
+
+
+ResultCache& ResultCache::operator=(const ResultCache& other) {
+    if (this != &other) {
+        std::scoped_lock guard(mutex_, other.mutex_);
+        capacity_.store(other.capacity_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        generation_ = 0;
+        entries_.clear();
+        entry_by_key_.clear();
+        stats_ = {};
+    }
+    return *this;
+}
+
+
+void ResultCache::SetCapacity(size_t capacity) {
+    std::lock_guard guard(mutex_);
+    capacity_.store(capacity, std::memory_order_relaxed);
+    Shrink();
+}
+
+
+bool ResultCache::IsEnabled() const {
+    return capacity_.load(std::memory_order_relaxed) > 0;
+}
+
+
+std::optional<std::vector<Document>> ResultCache::Find(const std::string& key, std::uint64_t generation) {
+    std::lock_guard guard(mutex_);
+    Invalidate(generation);
+    const auto entry_it = entry_by_key_.find(key);
+    if (entry_it == entry_by_key_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    ++stats_.hits;
+    entries_.splice(entries_.begin(), entries_, entry_it->second);
+    return entry_it->second->documents;
+}
+
+
+void ResultCache::Insert(std::string key, std::uint64_t generation, std::vector<Document> documents) {
+    std::lock_guard guard(mutex_);
+    Invalidate(generation);
+    if (capacity_.load(std::memory_order_relaxed) == 0 || entry_by_key_.count(key) > 0) {
+        return;
+    }
+    entries_.push_front({ std::move(key), std::move(documents) });
+    entry_by_key_.emplace(entries_.front().key, entries_.begin());
+    Shrink();
+}
+
+
+ResultCacheStats ResultCache::GetStats() const {
+    std::lock_guard guard(mutex_);
+    return stats_;
+}
+
+
+void ResultCache::Invalidate(std::uint64_t generation) {
+    if (generation_ != generation) {
+        entries_.clear();
+        entry_by_key_.clear();
+        generation_ = generation;
+    }
+}
+
+
+void ResultCache::Shrink() {
+    while (entries_.size() > capacity_.load(std::memory_order_relaxed)) {
+        entry_by_key_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include "document.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ResultCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+};
+
+// LRU-кэш результатов поиска. Каждая запись помечена поколением индекса, для которого
+// она посчитана; при обращении с другим поколением кэш целиком сбрасывается.
+// Все операции потокобезопасны. Копия получает ту же емкость, но пустое содержимое
+// и нулевые счетчики.
+class ResultCache {
+public:
+    ResultCache() = default;
+
+    ResultCache(const ResultCache& other);
+
+    ResultCache& operator=(const ResultCache& other);
+
+    // Нулевая емкость отключает кэш
+    void SetCapacity(size_t capacity);
+
+    // Не блокирует мьютекс, поэтому отключенный кэш ничего не стоит поиску
+    bool IsEnabled() const;
+
+    std::optional<std::vector<Document>> Find(const std::string& key, std::uint64_t generation);
+
+    void Insert(std::string key, std::uint64_t generation, std::vector<Document> documents);
+
+    ResultCacheStats GetStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::vector<Document> documents;
+    };
+
+    mutable std::mutex mutex_;
+    // Меняется под mutex_, но читается и без него
+    std::atomic<size_t> capacity_ = 0;
+    std::uint64_t generation_ = 0;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> entry_by_key_;
+    ResultCacheStats stats_;
+
+    void Invalidate(std::uint64_t generation);
+
+    void Shrink();
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "score_accumulator.h"
+
+namespace {
+
+thread_local std::vector<std::unique_ptr<ScoreAccumulator>> free_accumulators;
+
+} // namespace
+
+
+ScoreAccumulator::Lease::~Lease() {
+    free_accumulators.push_back(std::move(accumulator_));
+}
+
+
+ScoreAccumulator::Lease ScoreAccumulator::Acquire(size_t ordinal_count) {
+    std::unique_ptr<ScoreAccumulator> accumulator;
+    if (free_accumulators.empty()) {
+        accumulator = std::make_unique<ScoreAccumulator>();
+    } else {
+        accumulator = std::move(free_accumulators.back());
+        free_accumulators.pop_back();
+    }
+    accumulator->Reset(ordinal_count);
+    return Lease(std::move(accumulator));
+}
+
+
+void ScoreAccumulator::Reset(size_t ordinal_count) {
+    for (const int ordinal : touched_) {
+        scores_[ordinal] = 0.0;
+        is_touched_[ordinal] = false;
+    }
+    touched_.clear();
+    for (const int ordinal : excluded_) {
+        is_excluded_[ordinal] = false;
+    }
+    excluded_.clear();
+
+    if (scores_.size() < ordinal_count) {
+        scores_.resize(ordinal_count, 0.0);
+        is_touched_.resize(ordinal_count, false);
+        is_excluded_.resize(ordinal_count, false);
+    }
+}
\ No newline at end of file
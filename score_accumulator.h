@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Плотный накопитель релевантности по ординалам документов. Хранит массив оценок, список
+// затронутых ординалов и битовую карту исключенных минус-словами документов; сброс стоит
+// O(затронутых + исключенных), а не O(числа документов).
+// Накопители переиспользуются внутри потока через Acquire, поэтому их память выделяется
+// один раз на поток, а не на каждый запрос.
+class ScoreAccumulator {
+public:
+    // Владеет накопителем до конца области видимости и возвращает его в пул потока.
+    // Вложенный поиск (например, из предиката) получает отдельный накопитель.
+    class Lease {
+    public:
+        explicit Lease(std::unique_ptr<ScoreAccumulator> accumulator)
+            : accumulator_(std::move(accumulator)) {}
+
+        Lease(const Lease&) = delete;
+
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease();
+
+        ScoreAccumulator& operator*() const {
+            return *accumulator_;
+        }
+
+        ScoreAccumulator* operator->() const {
+            return accumulator_.get();
+        }
+
+    private:
+        std::unique_ptr<ScoreAccumulator> accumulator_;
+    };
+
+    // Накопитель текущего потока, очищенный и рассчитанный на ordinal_count ординалов
+    static Lease Acquire(size_t ordinal_count);
+
+    void Reset(size_t ordinal_count);
+
+    void Add(int ordinal, double score) {
+        if (!is_touched_[ordinal]) {
+            is_touched_[ordinal] = true;
+            touched_.push_back(ordinal);
+        }
+        scores_[ordinal] += score;
+    }
+
+    void Exclude(int ordinal) {
+        if (!is_excluded_[ordinal]) {
+            is_excluded_[ordinal] = true;
+            excluded_.push_back(ordinal);
+        }
+    }
+
+    bool IsExcluded(int ordinal) const {
+        return is_excluded_[ordinal];
+    }
+
+    double GetScore(int ordinal) const {
+        return scores_[ordinal];
+    }
+
+    // Ординалы, получившие оценку, в порядке первого обращения
+    const std::vector<int>& GetTouched() const {
+        return touched_;
+    }
+
+private:
+    std::vector<double> scores_;
+    std::vector<bool> is_touched_;
+    std::vector<int> touched_;
+    std::vector<bool> is_excluded_;
+    std::vector<int> excluded_;
+};
\ No newline at end of file
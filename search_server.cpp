@@ -1,70 +1,331 @@
 #include "search_server.h"
 
+#include <exception>
+#include <iterator>
 #include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+
+void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    CheckNewDocumentId(document_id);
+
+    int word_count = 0;
+    std::vector<DocumentTerm> document_terms;
+    {
+        TRACE_SCOPE(TraceStage::TOKENIZE_DOCUMENT);
+        const QueryArena::Scope tokenizer_arena;
+        const std::pmr::vector<std::string_view> document_words = SplitIntoWordsNoStop(document, tokenizer_arena.GetResource());
+        word_count = static_cast<int>(document_words.size());
+        document_terms.reserve(document_words.size());
+        for (const std::string_view word : document_words) {
+            document_terms.push_back({ terms_.AddTerm(word), 1 });
+        }
+        MergeDocumentTerms(document_terms);
+    }
+    const int ordinal = AppendDocument(document_id, ComputeAverageRating(ratings), status, word_count, std::move(document_terms));
 
+    if (static_cast<int>(postings_.size()) < terms_.GetTermCount()) {
+        postings_.resize(terms_.GetTermCount());
+    }
+    for (const auto& [term_id, term_count] : documents_.terms[ordinal]) {
+        postings_[term_id].Add(ordinal, term_count);
+        UpdateDocumentFrequency(term_id);
+    }
+    UpdateDocumentCount(document_count_ + 1);
+    ++index_generation_;
 
-void SearchServer::AddDocument(int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings) {
-    if (document_id < 0) {
-        throw std::invalid_argument("Document ID is less than 0");
+    return;
+}
+
+
+void SearchServer::AddDocuments(const std::vector<RawDocument>& documents) {
+    AddDocuments(std::execution::seq, documents);
+}
+
+
+void SearchServer::AddDocuments(const std::execution::sequenced_policy& policy, const std::vector<RawDocument>& documents) {
+    AddDocumentsInChunks(policy, documents, 1);
+}
+
+
+void SearchServer::AddDocuments(const std::execution::parallel_policy& policy, const std::vector<RawDocument>& documents) {
+    const size_t chunk_count = std::max(1u, std::thread::hardware_concurrency()) * 4;
+    AddDocumentsInChunks(policy, documents, std::min(chunk_count, std::max<size_t>(documents.size(), 1)));
+}
+
+
+template <typename ExecutionPolicy>
+void SearchServer::AddDocumentsInChunks(const ExecutionPolicy& policy, const std::vector<RawDocument>& documents, size_t chunk_count) {
+    std::vector<std::span<const RawDocument>> chunks;
+    chunks.reserve(chunk_count);
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const size_t begin = documents.size() * chunk / chunk_count;
+        const size_t end = documents.size() * (chunk + 1) / chunk_count;
+        chunks.push_back(std::span(documents).subspan(begin, end - begin));
     }
-    if (documents_statuses_.contains(document_id)) {
-        throw std::invalid_argument("Document with this ID already added");
+    std::vector<PreparedDocuments> batches(chunk_count);
+    std::transform(policy, chunks.begin(), chunks.end(), batches.begin(),
+                   [this](std::span<const RawDocument> chunk) { return PrepareDocuments(chunk); });
+    MergePreparedDocuments(policy, std::span(batches));
+}
+
+
+SearchServer::PreparedDocuments SearchServer::PrepareDocuments(std::span<const RawDocument> documents) const {
+    PreparedDocuments prepared;
+    prepared.ids_.reserve(documents.size());
+    prepared.ratings_.reserve(documents.size());
+    prepared.statuses_.reserve(documents.size());
+    prepared.word_counts_.reserve(documents.size());
+    prepared.documents_terms_.reserve(documents.size());
+    prepared.errors_.reserve(documents.size());
+
+    std::unordered_map<std::string_view, int> term_ids;
+    for (const RawDocument& document : documents) {
+        std::vector<DocumentTerm> document_terms;
+        int word_count = 0;
+        std::exception_ptr error;
+        try {
+            TRACE_SCOPE(TraceStage::TOKENIZE_DOCUMENT);
+            const QueryArena::Scope tokenizer_arena;
+            const std::pmr::vector<std::string_view> document_words = SplitIntoWordsNoStop(document.content, tokenizer_arena.GetResource());
+            word_count = static_cast<int>(document_words.size());
+            document_terms.reserve(document_words.size());
+            for (const std::string_view word : document_words) {
+                const auto [term_it, inserted] = term_ids.emplace(word, static_cast<int>(prepared.terms_.size()));
+                if (inserted) {
+                    prepared.terms_.push_back(word);
+                }
+                document_terms.push_back({ term_it->second, 1 });
+            }
+            MergeDocumentTerms(document_terms);
+        } catch (...) {
+            error = std::current_exception();
+            document_terms.clear();
+            word_count = 0;
+        }
+        prepared.ids_.push_back(document.id);
+        prepared.ratings_.push_back(ComputeAverageRating(document.ratings));
+        prepared.statuses_.push_back(document.status);
+        prepared.word_counts_.push_back(word_count);
+        prepared.documents_terms_.push_back(std::move(document_terms));
+        prepared.errors_.push_back(error);
     }
 
-    std::vector<std::string> document_words = SplitIntoWordsNoStop(document);
-    double word_tf = 1.0 / document_words.size();
-    documents_ratings_[document_id] = ComputeAverageRating(ratings);
-    documents_statuses_[document_id] = status;
-    for (const std::string& word : document_words) {
-        documents_[word][document_id] += word_tf;
+    return prepared;
+}
+
+
+void SearchServer::AddPreparedDocuments(std::vector<PreparedDocuments> batches) {
+    MergePreparedDocuments(std::execution::seq, std::span(batches));
+}
+
+
+template <typename ExecutionPolicy>
+void SearchServer::MergePreparedDocuments(const ExecutionPolicy& policy, std::span<PreparedDocuments> batches) {
+    // Первой выбрасывается ошибка первого по порядку неверного документа: сначала проверяется его ID, затем слова
+    std::unordered_set<int> batch_ids;
+    for (const PreparedDocuments& batch : batches) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            CheckPreparedDocument(batch, i, batch_ids);
+        }
     }
-    document_ids_.push_back(document_id);
-    ++document_count_;
 
-    return;
+    // Слова пачек получают глобальные ID, а затронутые слова - плотные номера, по которым
+    // считается число новых записей каждого слова. Все рабочие массивы растут с числом
+    // затронутых слов, а не со всем словарем.
+    std::unordered_map<int, int> dense_term_ids;
+    std::vector<int> touched_term_ids;
+    std::vector<int> entry_offsets(1, 0);
+    std::vector<std::vector<int>> batches_global_term_ids(batches.size());
+    std::vector<std::vector<int>> batches_dense_term_ids(batches.size());
+    for (size_t batch_index = 0; batch_index < batches.size(); ++batch_index) {
+        const PreparedDocuments& batch = batches[batch_index];
+        std::vector<int>& global_term_ids = batches_global_term_ids[batch_index];
+        std::vector<int>& batch_dense_term_ids = batches_dense_term_ids[batch_index];
+        global_term_ids.reserve(batch.terms_.size());
+        batch_dense_term_ids.reserve(batch.terms_.size());
+        for (const std::string_view word : batch.terms_) {
+            const int term_id = terms_.AddTerm(word);
+            const auto [dense_it, inserted] = dense_term_ids.emplace(term_id, static_cast<int>(touched_term_ids.size()));
+            if (inserted) {
+                touched_term_ids.push_back(term_id);
+                entry_offsets.push_back(0);
+            }
+            global_term_ids.push_back(term_id);
+            batch_dense_term_ids.push_back(dense_it->second);
+        }
+        // Термины документа уже слиты по слову, поэтому каждый дает одну запись
+        for (const std::vector<DocumentTerm>& document_terms : batch.documents_terms_) {
+            for (const DocumentTerm& document_term : document_terms) {
+                ++entry_offsets[batch_dense_term_ids[document_term.term_id] + 1];
+            }
+        }
+    }
+    std::partial_sum(entry_offsets.begin(), entry_offsets.end(), entry_offsets.begin());
+
+    // Новые записи всех слов раскладываются в один массив по ординалам, поэтому внутри слова они отсортированы
+    std::vector<PostingList::Entry> new_entries(entry_offsets.back());
+    std::vector<int> entry_ends(entry_offsets.begin(), entry_offsets.end() - 1);
+    for (size_t batch_index = 0; batch_index < batches.size(); ++batch_index) {
+        PreparedDocuments& batch = batches[batch_index];
+        const std::vector<int>& global_term_ids = batches_global_term_ids[batch_index];
+        const std::vector<int>& batch_dense_term_ids = batches_dense_term_ids[batch_index];
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const int ordinal = static_cast<int>(documents_.ids.size());
+            std::vector<DocumentTerm>& document_terms = batch.documents_terms_[i];
+            for (DocumentTerm& document_term : document_terms) {
+                new_entries[entry_ends[batch_dense_term_ids[document_term.term_id]]++] = { ordinal, document_term.term_count };
+                document_term.term_id = global_term_ids[document_term.term_id];
+            }
+            MergeDocumentTerms(document_terms);
+            AppendDocument(batch.ids_[i], batch.ratings_[i], batch.statuses_[i], batch.word_counts_[i], std::move(document_terms));
+        }
+    }
+
+    postings_.resize(terms_.GetTermCount());
+    // Каждый список документов изменяется ровно одной задачей. Ординалы выдавались по возрастанию,
+    // поэтому записи дописываются в конец списков.
+    std::vector<int> dense_term_range(touched_term_ids.size());
+    std::iota(dense_term_range.begin(), dense_term_range.end(), 0);
+    std::for_each(policy, dense_term_range.begin(), dense_term_range.end(),
+        [this, &new_entries, &entry_offsets, &touched_term_ids](int dense_term_id) {
+            const int term_id = touched_term_ids[dense_term_id];
+            const size_t entry_count = entry_offsets[dense_term_id + 1] - entry_offsets[dense_term_id];
+            postings_[term_id].AddEntries(std::span(new_entries).subspan(entry_offsets[dense_term_id], entry_count));
+            UpdateDocumentFrequency(term_id);
+        });
+    UpdateDocumentCount(static_cast<int>(document_ordinals_.size()));
+    ++index_generation_;
 }
 
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query, DocumentStatus status) const {
-    return FindTopDocuments(raw_query, [status](int document_id, DocumentStatus document_status, int rating) { return document_status == status; });
+SearchServer SearchServer::CreateEmpty() const {
+    SearchServer search_server;
+    search_server.stop_words_ = stop_words_;
+    return search_server;
 }
 
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query) const {
-    return FindTopDocuments(raw_query, [](int document_id, DocumentStatus document_status, int rating) { return document_status == DocumentStatus::ACTUAL; });
+SearchServer::PreparedDocuments SearchServer::ExportDocuments(int first_ordinal, int last_ordinal) const {
+    PreparedDocuments exported;
+    std::unordered_map<int, int> local_term_ids;
+    for (int ordinal = first_ordinal; ordinal < last_ordinal; ++ordinal) {
+        // ID удаленного документа мог быть добавлен заново с новым ординалом
+        const int document_id = documents_.ids[ordinal];
+        if (const auto ordinal_it = document_ordinals_.find(document_id); ordinal_it == document_ordinals_.end() || ordinal_it->second != ordinal) {
+            continue;
+        }
+        std::vector<DocumentTerm> document_terms = documents_.terms[ordinal];
+        for (DocumentTerm& document_term : document_terms) {
+            const auto [local_it, inserted] = local_term_ids.emplace(document_term.term_id, static_cast<int>(exported.terms_.size()));
+            if (inserted) {
+                exported.terms_.push_back(terms_.GetTerm(document_term.term_id));
+            }
+            document_term.term_id = local_it->second;
+        }
+        exported.ids_.push_back(document_id);
+        exported.ratings_.push_back(documents_.ratings[ordinal]);
+        exported.statuses_.push_back(documents_.statuses[ordinal]);
+        exported.word_counts_.push_back(documents_.word_counts[ordinal]);
+        exported.documents_terms_.push_back(std::move(document_terms));
+        exported.errors_.emplace_back();
+    }
+    return exported;
+}
+
+
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t result_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, status, result_count);
 }
 
 
-std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(const std::string& raw_query, int document_id) const {
-    std::vector<std::string> plus_words;
-    QueryWords query_words = ParseQuery(raw_query);
-    std::tuple<std::vector<std::string>, DocumentStatus> result;
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, size_t result_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, DocumentStatus::ACTUAL, result_count);
+}
+
+
+// Продолжения выдачи не кэшируются: ключом пришлось бы делать и курсор, а повторный запрос той же
+// глубокой страницы маловероятен
+std::vector<Document> SearchServer::FindTopDocumentsAfter(std::string_view raw_query, const Document& after, DocumentStatus status,
+                                                          size_t result_count) const {
+    const QueryArena::Scope query_arena;
+    return FindTopDocumentsForQuery(std::execution::seq, ParseQuery(raw_query, query_arena.GetResource()), MakeStatusFilter(status),
+                                    result_count, &after);
+}
+
+
+std::vector<Document> SearchServer::FindTopDocumentsAfter(std::string_view raw_query, const Document& after, size_t result_count) const {
+    return FindTopDocumentsAfter(raw_query, after, DocumentStatus::ACTUAL, result_count);
+}
+
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+    return MatchDocument(std::execution::seq, raw_query, document_id);
+}
+
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::sequenced_policy&,
+                                                                                      std::string_view raw_query, int document_id) const {
+    const QueryArena::Scope query_arena;
+    const QueryWords query_words = ParseQuery(raw_query, query_arena.GetResource());
+    const int ordinal = document_ordinals_.at(document_id);
+    const DocumentStatus status = documents_.statuses[ordinal];
+
+    for (const std::string_view word : query_words.minus_words) {
+        if (FindDocumentTerm(ordinal, word) != TermDictionary::NO_TERM) {
+            return { std::vector<std::string_view>{}, status };
+        }
+    }
 
-    for (const std::string& word : query_words.minus_words) {
-        if (documents_.contains(word) && documents_.at(word).contains(document_id)) {
-            result = std::tuple(plus_words, documents_statuses_.at(document_id));
-            return result;
+    std::vector<std::string_view> matched_words;
+    matched_words.reserve(query_words.plus_words.size());
+    for (const std::string_view word : query_words.plus_words) {
+        const int term_id = FindDocumentTerm(ordinal, word);
+        if (term_id != TermDictionary::NO_TERM) {
+            matched_words.push_back(terms_.GetTerm(term_id));
         }
     }
 
-    for (const std::string& word : query_words.plus_words) {
-        if (documents_.contains(word) && documents_.at(word).contains(document_id)) {
-            plus_words.push_back(word);
+    return { std::move(matched_words), status };
+}
+
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::parallel_policy& policy,
+                                                                                      std::string_view raw_query, int document_id) const {
+    const QueryArena::Scope query_arena;
+    const QueryWords query_words = ParseQuery(raw_query, query_arena.GetResource());
+    const int ordinal = document_ordinals_.at(document_id);
+    const DocumentStatus status = documents_.statuses[ordinal];
+    const auto find_document_term = [this, ordinal](std::string_view word) { return FindDocumentTerm(ordinal, word); };
+
+    if (std::any_of(policy, query_words.minus_words.begin(), query_words.minus_words.end(),
+                    [&find_document_term](std::string_view word) { return find_document_term(word) != TermDictionary::NO_TERM; })) {
+        return { std::vector<std::string_view>{}, status };
+    }
+
+    std::pmr::vector<int> term_ids(query_words.plus_words.size(), query_arena.GetResource());
+    std::transform(policy, query_words.plus_words.begin(), query_words.plus_words.end(), term_ids.begin(), find_document_term);
+
+    std::vector<std::string_view> matched_words;
+    matched_words.reserve(term_ids.size());
+    for (const int term_id : term_ids) {
+        if (term_id != TermDictionary::NO_TERM) {
+            matched_words.push_back(terms_.GetTerm(term_id));
         }
     }
 
-    std::sort(plus_words.begin(), plus_words.end());
-    result = std::tuple(plus_words, documents_statuses_.at(document_id));
-    return result;
+    return { std::move(matched_words), status };
 }
 
 
 int SearchServer::GetDocumentId(int index) const {
-    if (index < 0 || index >= static_cast<int>(document_ids_.size())) {
+    if (index < 0 || index >= live_ordinals_.GetLiveCount()) {
         throw std::out_of_range("ID of document is incorrrect");
     }
 
-    return document_ids_.at(index);
+    return documents_.ids[live_ordinals_.FindOrdinal(index)];
 }
 
 
@@ -73,7 +334,122 @@ int SearchServer::GetDocumentCount() const {
 }
 
 
-bool SearchServer::IsWordCorrect(const std::string& word) {
+IndexMemoryUsage SearchServer::GetMemoryUsage() const {
+    // Для узлов std::map учитывается служебная часть красно-черного дерева
+    const size_t map_node_overhead = 4 * sizeof(void*);
+    IndexMemoryUsage memory_usage;
+
+    memory_usage.postings = postings_.capacity() * sizeof(PostingList) + terms_data_.capacity() * sizeof(TermData);
+    for (const PostingList& postings : postings_) {
+        memory_usage.postings += postings.GetMemoryUsage() - sizeof(PostingList);
+    }
+    memory_usage.terms = terms_.GetMemoryUsage();
+    for (const std::vector<DocumentTerm>& document_terms : documents_.terms) {
+        memory_usage.documents += document_terms.capacity() * sizeof(DocumentTerm);
+    }
+    memory_usage.documents += documents_.terms.capacity() * sizeof(std::vector<DocumentTerm>)
+                              + (documents_.ids.capacity() + documents_.ratings.capacity() + documents_.word_counts.capacity()) * sizeof(int)
+                              + documents_.statuses.capacity() * sizeof(DocumentStatus);
+    for (const std::vector<bool>& status_bitmap : documents_.status_bitmaps) {
+        memory_usage.documents += status_bitmap.capacity() / 8;
+    }
+    memory_usage.documents += document_ordinals_.size() * (map_node_overhead + 2 * sizeof(int))
+                              + live_ordinals_.GetMemoryUsage();
+
+    return memory_usage;
+}
+
+
+std::map<std::string_view, double> SearchServer::GetWordFrequencies(int document_id) const {
+    std::map<std::string_view, double> word_freqs;
+
+    const auto ordinal_it = document_ordinals_.find(document_id);
+    if (ordinal_it == document_ordinals_.end()) {
+        return word_freqs;
+    }
+    const int word_count = documents_.word_counts[ordinal_it->second];
+    for (const auto& [term_id, term_count] : documents_.terms[ordinal_it->second]) {
+        word_freqs.emplace(terms_.GetTerm(term_id), static_cast<double>(term_count) / word_count);
+    }
+    return word_freqs;
+}
+
+
+std::optional<TermStatistics> SearchServer::GetTermStatistics(std::string_view word) const {
+    const int term_id = FindIndexedTerm(word);
+    if (term_id == TermDictionary::NO_TERM) {
+        return std::nullopt;
+    }
+    return TermStatistics{ static_cast<int>(postings_[term_id].size()), ComputeInverseDocumentFrequency(term_id),
+                           terms_data_[term_id].max_term_frequency };
+}
+
+
+void SearchServer::RemoveDocument(int document_id) {
+    RemoveDocument(std::execution::seq, document_id);
+}
+
+
+void SearchServer::RemoveDocument(const std::execution::sequenced_policy& policy, int document_id) {
+    RemoveDocumentTerms(policy, document_id);
+}
+
+
+void SearchServer::RemoveDocument(const std::execution::parallel_policy& policy, int document_id) {
+    RemoveDocumentTerms(policy, document_id);
+}
+
+
+// Сжатый индекс строится заново из живых документов; его словарь перемещается вместе со строками,
+// поэтому ссылки на слова внутри индекса остаются действительными
+void SearchServer::Compact() {
+    SearchServer compacted = CreateEmpty();
+    std::vector<PreparedDocuments> batches;
+    batches.push_back(ExportDocuments(0, static_cast<int>(documents_.ids.size())));
+    compacted.AddPreparedDocuments(std::move(batches));
+
+    terms_ = std::move(compacted.terms_);
+    postings_ = std::move(compacted.postings_);
+    terms_data_ = std::move(compacted.terms_data_);
+    documents_ = std::move(compacted.documents_);
+    document_ordinals_ = std::move(compacted.document_ordinals_);
+    live_ordinals_ = std::move(compacted.live_ordinals_);
+    UpdateDocumentCount(compacted.document_count_);
+    snapshot_file_.reset();
+    ++index_generation_;
+}
+
+
+template <typename ExecutionPolicy>
+void SearchServer::RemoveDocumentTerms(const ExecutionPolicy& policy, int document_id) {
+    const auto ordinal_it = document_ordinals_.find(document_id);
+    if (ordinal_it == document_ordinals_.end()) {
+        return;
+    }
+    const int ordinal = ordinal_it->second;
+
+    // Каждый термин документа владеет своим списком, поэтому списки можно чистить независимо
+    std::for_each(policy, documents_.terms[ordinal].begin(), documents_.terms[ordinal].end(),
+        [this, ordinal](const DocumentTerm& document_term) {
+            postings_[document_term.term_id].Remove(ordinal);
+            UpdateDocumentFrequency(document_term.term_id);
+        });
+    std::vector<DocumentTerm>().swap(documents_.terms[ordinal]);
+    EraseDocumentAttributes(document_id);
+}
+
+
+void SearchServer::EraseDocumentAttributes(int document_id) {
+    const auto ordinal_it = document_ordinals_.find(document_id);
+    documents_.status_bitmaps[static_cast<size_t>(documents_.statuses[ordinal_it->second])][ordinal_it->second] = false;
+    live_ordinals_.Remove(ordinal_it->second);
+    document_ordinals_.erase(ordinal_it);
+    UpdateDocumentCount(document_count_ - 1);
+    ++index_generation_;
+}
+
+
+bool SearchServer::IsWordCorrect(std::string_view word) {
     for (const char c : word) {
         if (c >= '\0' && c < ' ') {
             return false;
@@ -83,30 +459,33 @@ bool SearchServer::IsWordCorrect(const std::string& word) {
 }
 
 
-bool SearchServer::IsStopWord(const std::string& word) const {
-    return stop_words_.count(word) > 0;
+bool SearchServer::IsStopWord(std::string_view word) const {
+    return stop_words_.contains(word);
 }
 
 
-std::vector<std::string> SearchServer::SplitIntoWordsNoStop(const std::string& text) const {
-    std::vector<std::string> words;
-    for (const std::string& word : SplitIntoWords(text)) {
+std::pmr::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(std::string_view text, std::pmr::memory_resource* resource) const {
+    std::pmr::vector<std::string_view> words = SplitIntoWords(text, resource);
+    for (const std::string_view word : words) {
         if (!IsWordCorrect(word)) {
-            throw std::invalid_argument("The word \"" + word + "\" contains forbidden symbol");
-        }
-        if (!IsStopWord(word)) {
-            words.push_back(word);
+            throw std::invalid_argument("The word \"" + std::string(word) + "\" contains forbidden symbol");
         }
     }
+    words.erase(std::remove_if(words.begin(), words.end(), [this](std::string_view word) { return IsStopWord(word); }),
+                words.end());
 
     return words;
 }
 
 
-SearchServer::QueryWords SearchServer::ParseQuery(const std::string& text) const {
-    QueryWords query_words;
+SearchServer::QueryWords SearchServer::ParseQuery(std::string_view text, std::pmr::memory_resource* resource) const {
+    TRACE_SCOPE(TraceStage::PARSE_QUERY);
+    QueryWords query_words(resource);
+    const std::pmr::vector<std::string_view> words = SplitIntoWordsNoStop(text, resource);
+    query_words.plus_words.reserve(words.size());
+    query_words.minus_words.reserve(words.size());
 
-    for (const std::string& word : SplitIntoWordsNoStop(text)) {
+    for (const std::string_view word : words) {
         if (word[0] == '-') {
             if (word.size() == 1) {
                 throw std::invalid_argument("The minus word consists only from minus");
@@ -114,17 +493,158 @@ SearchServer::QueryWords SearchServer::ParseQuery(const std::string& text) const
             if (word[1] == '-') {
                 throw std::invalid_argument("The minus word is misspelled");
             }
-            query_words.minus_words.insert(word.substr(1));
+            query_words.minus_words.push_back(word.substr(1));
         }
         else {
-            query_words.plus_words.insert(word);
+            query_words.plus_words.push_back(word);
         }
     }
 
+    for (std::pmr::vector<std::string_view>* query_part : {&query_words.plus_words, &query_words.minus_words}) {
+        std::sort(query_part->begin(), query_part->end());
+        query_part->erase(std::unique(query_part->begin(), query_part->end()), query_part->end());
+    }
+
     return query_words;
 }
 
 
+void SearchServer::SetResultCacheCapacity(size_t capacity) {
+    result_cache_.SetCapacity(capacity);
+}
+
+
+ResultCacheStats SearchServer::GetResultCacheStats() const {
+    return result_cache_.GetStats();
+}
+
+
+// Слова не содержат пробелов и переводов строки, поэтому они служат разделителями
+std::string SearchServer::MakeResultCacheKey(const QueryWords& query_words, DocumentStatus status, size_t result_count) {
+    std::string key = std::to_string(static_cast<int>(status)) + ' ' + std::to_string(result_count);
+    for (const std::pmr::vector<std::string_view>* words : { &query_words.plus_words, &query_words.minus_words }) {
+        key.push_back('\n');
+        for (const std::string_view word : *words) {
+            key.append(word);
+            key.push_back(' ');
+        }
+    }
+    return key;
+}
+
+
+int SearchServer::FindIndexedTerm(std::string_view word) const {
+    const int term_id = terms_.FindTerm(word);
+    if (term_id == TermDictionary::NO_TERM || postings_[term_id].empty()) {
+        return TermDictionary::NO_TERM;
+    }
+    return term_id;
+}
+
+
+int SearchServer::FindDocumentTerm(int ordinal, std::string_view word) const {
+    const int term_id = terms_.FindTerm(word);
+    if (term_id == TermDictionary::NO_TERM) {
+        return TermDictionary::NO_TERM;
+    }
+    const std::vector<DocumentTerm>& document_terms = documents_.terms[ordinal];
+    const auto term_it = std::lower_bound(document_terms.begin(), document_terms.end(), term_id,
+        [](const DocumentTerm& document_term, int id) { return document_term.term_id < id; });
+    return term_it != document_terms.end() && term_it->term_id == term_id ? term_id : TermDictionary::NO_TERM;
+}
+
+
+void SearchServer::ExcludeMinusWordDocuments(const QueryWords& query_words, ScoreAccumulator& accumulator) const {
+    for (const std::string_view minus_word : query_words.minus_words) {
+        const int term_id = FindIndexedTerm(minus_word);
+        if (term_id == TermDictionary::NO_TERM) {
+            continue;
+        }
+        for (const auto [ordinal, term_count] : postings_[term_id]) {
+            accumulator.Exclude(ordinal);
+        }
+    }
+}
+
+
+void SearchServer::CheckPreparedDocument(const PreparedDocuments& batch, size_t index, std::unordered_set<int>& batch_ids) const {
+    CheckNewDocumentId(batch.ids_[index]);
+    if (!batch_ids.insert(batch.ids_[index]).second) {
+        throw std::invalid_argument("Document with this ID already added");
+    }
+    if (batch.errors_[index]) {
+        std::rethrow_exception(batch.errors_[index]);
+    }
+}
+
+
+void SearchServer::CheckNewDocumentId(int document_id) const {
+    if (document_id < 0) {
+        throw std::invalid_argument("Document ID is less than 0");
+    }
+    if (document_ordinals_.contains(document_id)) {
+        throw std::invalid_argument("Document with this ID already added");
+    }
+}
+
+
+int SearchServer::AppendDocument(int document_id, int rating, DocumentStatus status, int word_count,
+                                 std::vector<DocumentTerm> document_terms) {
+    const int ordinal = static_cast<int>(documents_.ids.size());
+    UpdateMaxTermFrequencies(document_terms, word_count);
+    documents_.ids.push_back(document_id);
+    documents_.ratings.push_back(rating);
+    documents_.statuses.push_back(status);
+    documents_.word_counts.push_back(word_count);
+    documents_.terms.push_back(std::move(document_terms));
+    for (size_t bitmap_status = 0; bitmap_status < DOCUMENT_STATUS_COUNT; ++bitmap_status) {
+        documents_.status_bitmaps[bitmap_status].push_back(bitmap_status == static_cast<size_t>(status));
+    }
+    document_ordinals_.emplace(document_id, ordinal);
+    live_ordinals_.Append();
+    return ordinal;
+}
+
+
+void SearchServer::MergeDocumentTerms(std::vector<DocumentTerm>& document_terms) {
+    std::sort(document_terms.begin(), document_terms.end(),
+              [](const DocumentTerm& lhs, const DocumentTerm& rhs) { return lhs.term_id < rhs.term_id; });
+    auto merged_end = document_terms.begin();
+    for (auto term_it = document_terms.begin(); term_it != document_terms.end(); ++term_it) {
+        if (merged_end != document_terms.begin() && std::prev(merged_end)->term_id == term_it->term_id) {
+            std::prev(merged_end)->term_count += term_it->term_count;
+        } else {
+            *merged_end++ = *term_it;
+        }
+    }
+    document_terms.erase(merged_end, document_terms.end());
+    document_terms.shrink_to_fit();
+}
+
+
+void SearchServer::UpdateMaxTermFrequencies(const std::vector<DocumentTerm>& document_terms, int word_count) {
+    if (terms_data_.size() < static_cast<size_t>(terms_.GetTermCount())) {
+        terms_data_.resize(terms_.GetTermCount());
+    }
+    for (const auto& [term_id, term_count] : document_terms) {
+        double& max_term_frequency = terms_data_[term_id].max_term_frequency;
+        max_term_frequency = std::max(max_term_frequency, static_cast<double>(term_count) / word_count);
+    }
+}
+
+
+void SearchServer::UpdateDocumentFrequency(int term_id) {
+    const size_t document_frequency = postings_[term_id].size();
+    terms_data_[term_id].log_document_frequency = document_frequency > 0 ? std::log(static_cast<double>(document_frequency)) : 0.0;
+}
+
+
+void SearchServer::UpdateDocumentCount(int document_count) {
+    document_count_ = document_count;
+    log_document_count_ = document_count > 0 ? std::log(static_cast<double>(document_count)) : 0.0;
+}
+
+
 int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
     if (ratings.size() == 0) {
         return 0;
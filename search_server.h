@@ -1,133 +1,697 @@
 #pragma once
+#include "concurrent_map.h"
 #include "document.h"
+#include "live_ordinals.h"
+#include "mapped_file.h"
+#include "posting_list.h"
+#include "query_arena.h"
+#include "result_cache.h"
+#include "score_accumulator.h"
 #include "string_processing.h"
+#include "term_dictionary.h"
+#include "trace_hooks.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <exception>
+#include <execution>
+#include <limits>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
+#include <unordered_set>
 #include <vector>
 
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
 const double EPSILON = 1e-6;
+const size_t CONCURRENT_BUCKET_COUNT = 100;
+
+
+struct RawDocument {
+    int id = 0;
+    std::string_view content;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+};
+
+
+struct TermStatistics {
+    int document_frequency = 0;
+    double inverse_document_frequency = 0.0;
+    double max_term_frequency = 0.0;
+};
+
+
+struct IndexMemoryUsage {
+    size_t postings = 0;
+    size_t terms = 0;
+    size_t documents = 0;
+
+    size_t GetTotal() const {
+        return postings + terms + documents;
+    }
+};
+
+
+template <typename ExecutionPolicy>
+concept ExecutionPolicyType = std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>;
+
+template <typename PredicateFunc>
+concept DocumentPredicate = std::is_invocable_r_v<bool, PredicateFunc, int, DocumentStatus, int>;
 
 
 class SearchServer {
 public:
-    explicit SearchServer(const std::string& text) 
+    explicit SearchServer(std::string_view text)
         : SearchServer(SplitIntoWords(text)) {}
 
     template <typename StringCollection>
+        requires (!std::is_convertible_v<const StringCollection&, std::string_view>)
     explicit SearchServer(const StringCollection& word_collection);
 
-    void AddDocument(int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings);
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    // Пакетная индексация: документы разбиваются на части, которые разбираются независимо
+    // в собственные частичные индексы, а затем сливаются в основной. Проверки те же, что
+    // у AddDocument; при ошибке исключение первого по порядку неверного документа
+    // выбрасывается до изменения индекса.
+    void AddDocuments(const std::vector<RawDocument>& documents);
+
+    void AddDocuments(const std::execution::sequenced_policy&, const std::vector<RawDocument>& documents);
+
+    void AddDocuments(const std::execution::parallel_policy&, const std::vector<RawDocument>& documents);
+
+    // Документы, разобранные на слова без обращения к индексу. Тексты документов должны жить
+    // до вызова AddPreparedDocuments.
+    class PreparedDocuments;
+
+    // Первая половина AddDocuments: разбор на слова. Сервер не меняется, читаются только стоп-слова,
+    // поэтому разбор можно вести в других потоках одновременно с индексацией предыдущих пачек.
+    // Ошибки в словах запоминаются и выбрасываются при добавлении.
+    PreparedDocuments PrepareDocuments(std::span<const RawDocument> documents) const;
+
+    // Вторая половина AddDocuments с теми же проверками и гарантиями. Пачки добавляются по порядку
+    // за один проход по спискам документов, поэтому несколько пачек дешевле сливать вместе.
+    void AddPreparedDocuments(std::vector<PreparedDocuments> batches);
 
-    template <typename PredicateFunc>
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, PredicateFunc predicate_func) const;
+    // result_count ограничивает число возвращаемых документов (по умолчанию MAX_RESULT_DOCUMENT_COUNT)
+    template <DocumentPredicate PredicateFunc>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, PredicateFunc predicate_func,
+                                           size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, DocumentStatus status) const;
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                           size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
-    std::vector<Document> FindTopDocuments(const std::string& raw_query) const;
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const;
+    template <ExecutionPolicyType ExecutionPolicy, DocumentPredicate PredicateFunc>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, PredicateFunc predicate_func,
+                                           size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template <ExecutionPolicyType ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+                                           size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template <ExecutionPolicyType ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                           size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    // Постраничная выдача: документы в порядке FindTopDocuments, идущие строго после after
+    // (обычно последнего документа предыдущей страницы). Учитываются только документы за курсором,
+    // поэтому страница N не требует сортировки всех предыдущих.
+    template <DocumentPredicate PredicateFunc>
+    std::vector<Document> FindTopDocumentsAfter(std::string_view raw_query, const Document& after, PredicateFunc predicate_func,
+                                                size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocumentsAfter(std::string_view raw_query, const Document& after, DocumentStatus status,
+                                                size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocumentsAfter(std::string_view raw_query, const Document& after,
+                                                size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    // Плюс-слова запроса, встречающиеся в документе, по алфавиту (пусто, если есть минус-слово).
+    // Строки принадлежат словарю индекса и действительны до Compact(), удаления этого документа
+    // или разрушения сервера, смотря что наступит раньше.
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::sequenced_policy&,
+                                                                            std::string_view raw_query, int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::parallel_policy&,
+                                                                            std::string_view raw_query, int document_id) const;
 
     int GetDocumentId(int index) const;
 
     int GetDocumentCount() const;
 
+    // Ключи ссылаются на словарь индекса и живут столько же, сколько строки MatchDocument
+    std::map<std::string_view, double> GetWordFrequencies(int document_id) const;
+
+    // Статистика слова, по которой считается релевантность; для отсутствующего в индексе слова - nullopt
+    std::optional<TermStatistics> GetTermStatistics(std::string_view word) const;
+
+    // Удаление документа затрагивает только его собственные слова; неизвестный ID игнорируется
+    void RemoveDocument(int document_id);
+
+    void RemoveDocument(const std::execution::sequenced_policy&, int document_id);
+
+    void RemoveDocument(const std::execution::parallel_policy&, int document_id);
+
+    // Удаленные документы сохраняют ординалы, поэтому столбцы атрибутов, битовые карты статусов
+    // и накопители оценок растут с числом когда-либо добавленных документов, а слова без документов
+    // остаются в словаре. Compact нумерует живые документы заново подряд и выбрасывает такие слова;
+    // стоит как индексация живых документов. Выдача и порядок GetDocumentId не меняются, но строки,
+    // полученные из MatchDocument и GetWordFrequencies, становятся недействительными.
+    void Compact();
+
+    IndexMemoryUsage GetMemoryUsage() const;
+
+    // Кэш результатов FindTopDocuments с фильтром по статусу. Ключ строится по нормализованным
+    // плюс- и минус-словам, поэтому запросы, отличающиеся порядком и повторами слов, делят запись.
+    // Любое изменение индекса делает кэш недействительным. Нулевая емкость (по умолчанию) отключает его.
+    void SetResultCacheCapacity(size_t capacity);
+
+    ResultCacheStats GetResultCacheStats() const;
+
+    // Снимок хранит стоп-слова, словарь, списки документов, рейтинги, статусы и порядок ID.
+    // У загруженного снимка списки документов читаются прямо из отображенного в память файла.
+    // Загрузка проверяет согласованность данных и бросает runtime_error для испорченного снимка.
+    void SaveSnapshot(const std::string& path) const;
+
+    static SearchServer LoadSnapshot(const std::string& path);
+
 private:
+    friend class ConcurrentSearchServer;
+    friend class PartitionedSearch;
+    friend class ShardedSearchServer;
+
+    SearchServer() = default;
+
+    // Слова запроса ссылаются на текст запроса; списки отсортированы и не содержат повторов.
+    // Списки размещаются в арене запроса и живут не дольше ее области.
     struct QueryWords {
-        std::set<std::string> plus_words;
-        std::set<std::string> minus_words;
+        explicit QueryWords(std::pmr::memory_resource* resource)
+            : plus_words(resource), minus_words(resource), plus_word_idfs(resource) {}
+
+        std::pmr::vector<std::string_view> plus_words;
+        std::pmr::vector<std::string_view> minus_words;
+        // IDF плюс-слов по всему корпусу в порядке plus_words, если индекс - лишь его часть;
+        // пустой список означает, что IDF считается по этому индексу
+        std::pmr::vector<double> plus_word_idfs;
     };
 
-    std::map<std::string, std::map<int, double>> documents_;
-    std::map<int, int> documents_ratings_;
-    std::map<int, DocumentStatus> documents_statuses_; 
+    // Логарифм частоты документов хранится вместо IDF: он меняется только вместе со списком
+    // документов слова, а IDF = log(document_count_) - log_document_frequency обновляется
+    // для всех слов сразу через log_document_count_.
+    struct TermData {
+        double log_document_frequency = 0.0;
+        // При удалении документов не уменьшается и остается верхней границей
+        double max_term_frequency = 0.0;
+    };
+
+    struct DocumentTerm {
+        int term_id;
+        int term_count;
+    };
+
+    static constexpr size_t DOCUMENT_STATUS_COUNT = static_cast<size_t>(DocumentStatus::REMOVED) + 1;
+
+    // Атрибуты документов хранятся столбцами по ординалу - внутреннему номеру документа.
+    // Ординалы выдаются по порядку добавления и до Compact не переиспользуются, а списки документов хранят
+    // ординалы, поэтому новые документы всегда дописываются в конец списков. Удаленный документ
+    // сохраняет ординал, но пропадает из списков документов, document_ordinals_ и битовых карт статусов.
+    struct DocumentColumns {
+        std::vector<int> ids;
+        std::vector<int> ratings;
+        std::vector<DocumentStatus> statuses;
+        std::vector<int> word_counts;
+        // Термины документа отсортированы по ID слова
+        std::vector<std::vector<DocumentTerm>> terms;
+        std::array<std::vector<bool>, DOCUMENT_STATUS_COUNT> status_bitmaps;
+    };
+
+    // Слова индекса заменены плотными ID из terms_; сжатые списки документов хранятся в массиве
+    // по ID слова. TF восстанавливается как term_count / word_count документа.
+    TermDictionary terms_;
+    std::vector<PostingList> postings_;
+    std::vector<TermData> terms_data_;
+    DocumentColumns documents_;
+    std::map<int, int> document_ordinals_;
     int document_count_ = 0;
-    std::set<std::string> stop_words_;
-    std::vector<int> document_ids_;
+    double log_document_count_ = 0.0;
+    std::set<std::string, std::less<>> stop_words_;
+    LiveOrdinals live_ordinals_;
+    std::shared_ptr<const MappedFile> snapshot_file_;
+    // Увеличивается при каждом изменении индекса
+    std::uint64_t index_generation_ = 0;
+    mutable ResultCache result_cache_;
+
+    static bool IsWordCorrect(std::string_view word);
+
+    bool IsStopWord(std::string_view word) const;
+
+    std::pmr::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text, std::pmr::memory_resource* resource) const;
+
+    QueryWords ParseQuery(std::string_view text, std::pmr::memory_resource* resource) const;
+
+    // ID слова, у которого есть документы, иначе TermDictionary::NO_TERM
+    int FindIndexedTerm(std::string_view word) const;
+
+    double ComputeInverseDocumentFrequency(int term_id) const {
+        return log_document_count_ - terms_data_[term_id].log_document_frequency;
+    }
+
+    double GetPlusWordIdf(const QueryWords& query_words, size_t word_index, int term_id) const {
+        return query_words.plus_word_idfs.empty() ? ComputeInverseDocumentFrequency(term_id) : query_words.plus_word_idfs[word_index];
+    }
+
+    template <DocumentPredicate PredicateFunc>
+    auto MakePredicateFilter(PredicateFunc& predicate_func) const {
+        return [this, &predicate_func](int ordinal) {
+            TRACE_COUNT(TraceStage::EVALUATE_PREDICATE);
+            return predicate_func(documents_.ids[ordinal], documents_.statuses[ordinal], documents_.ratings[ordinal]);
+        };
+    }
+
+    auto MakeStatusFilter(DocumentStatus status) const {
+        return [&status_bitmap = documents_.status_bitmaps[static_cast<size_t>(status)]](int ordinal) { return status_bitmap[ordinal]; };
+    }
+
+    static std::string MakeResultCacheKey(const QueryWords& query_words, DocumentStatus status, size_t result_count);
+
+    // ordinal_filter получает ординал документа и решает, участвует ли документ в поиске;
+    // при заданном after в результат попадают только документы, идущие после него
+    template <typename ExecutionPolicy, typename OrdinalFilter>
+    std::vector<Document> FindTopDocumentsForQuery(ExecutionPolicy&& policy, const QueryWords& query_words, OrdinalFilter ordinal_filter,
+                                                   size_t result_count, const Document* after = nullptr) const;
 
-    static bool IsWordCorrect(const std::string& word);
+    // ID слова, если оно есть среди слов документа, иначе TermDictionary::NO_TERM
+    int FindDocumentTerm(int ordinal, std::string_view word) const;
 
-    bool IsStopWord(const std::string& word) const;
+    // Помечает документы минус-слов исключенными, чтобы они не оценивались вовсе
+    void ExcludeMinusWordDocuments(const QueryWords& query_words, ScoreAccumulator& accumulator) const;
 
-    std::vector<std::string> SplitIntoWordsNoStop(const std::string& text) const;
+    template <typename OrdinalFilter>
+    std::vector<Document> FindTopDocumentsPruned(const QueryWords& query_words, OrdinalFilter ordinal_filter, size_t result_count,
+                                                 const Document* after) const;
 
-    QueryWords ParseQuery(const std::string& text) const;
+    template <typename OrdinalFilter>
+    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&,
+                                           const QueryWords& query_words, OrdinalFilter ordinal_filter) const;
 
-    template <typename PredicateFunc>
-    std::vector<Document> FindAllDocuments(const QueryWords& query_words, PredicateFunc predicate_func) const;
+    template <typename OrdinalFilter>
+    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy&,
+                                           const QueryWords& query_words, OrdinalFilter ordinal_filter) const;
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
+
+    void CheckNewDocumentId(int document_id) const;
+
+    // Проверки документа пачки в порядке AddDocument: ID, повтор ID в пачке (batch_ids), затем слова
+    void CheckPreparedDocument(const PreparedDocuments& batch, size_t index, std::unordered_set<int>& batch_ids) const;
+
+    int AppendDocument(int document_id, int rating, DocumentStatus status, int word_count, std::vector<DocumentTerm> document_terms);
+
+    static void MergeDocumentTerms(std::vector<DocumentTerm>& document_terms);
+
+    void UpdateMaxTermFrequencies(const std::vector<DocumentTerm>& document_terms, int word_count);
+
+    void UpdateDocumentFrequency(int term_id);
+
+    void UpdateDocumentCount(int document_count);
+
+    template <typename ExecutionPolicy>
+    void AddDocumentsInChunks(const ExecutionPolicy& policy, const std::vector<RawDocument>& documents, size_t chunk_count);
+
+    // Пустой сервер с теми же стоп-словами
+    SearchServer CreateEmpty() const;
+
+    // Живые документы с ординалами из [first_ordinal, last_ordinal) в виде пачки для AddPreparedDocuments.
+    // Слова пачки ссылаются на словарь этого сервера, рейтинги уже усреднены.
+    PreparedDocuments ExportDocuments(int first_ordinal, int last_ordinal) const;
+
+    // Сливает пачки в индекс по порядку; все проверки выполняются до изменения индекса
+    template <typename ExecutionPolicy>
+    void MergePreparedDocuments(const ExecutionPolicy& policy, std::span<PreparedDocuments> batches);
+
+    template <typename ExecutionPolicy>
+    void RemoveDocumentTerms(const ExecutionPolicy& policy, int document_id);
+
+    void EraseDocumentAttributes(int document_id);
+
+    static bool IsMoreRelevant(const Document& lhs, const Document& rhs);
+
+    template <typename ExecutionPolicy>
+    static void SelectTopDocuments(ExecutionPolicy&& policy, std::vector<Document>& documents, size_t result_count);
 };
 
 
-template <typename PredicateFunc>
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query, PredicateFunc predicate_func) const {
-    const QueryWords query_words = ParseQuery(raw_query);
-    std::vector<Document> result = FindAllDocuments(query_words, predicate_func);
-
-    std::sort(result.begin(), result.end(),
-        [](const Document& lhs, const Document& rhs) {
-            if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
-                return lhs.rating > rhs.rating;
-            } else {
-                return lhs.relevance > rhs.relevance;
-            }
-        });
+// Словарь пачки локальный: термины документов ссылаются на номера слов в terms_
+class SearchServer::PreparedDocuments {
+public:
+    size_t size() const {
+        return ids_.size();
+    }
+
+private:
+    friend class SearchServer;
+
+    std::vector<int> ids_;
+    std::vector<int> ratings_;
+    std::vector<DocumentStatus> statuses_;
+    std::vector<int> word_counts_;
+    std::vector<std::vector<DocumentTerm>> documents_terms_;
+    std::vector<std::string_view> terms_;
+    std::vector<std::exception_ptr> errors_;
+};
+
+
+template <DocumentPredicate PredicateFunc>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, PredicateFunc predicate_func,
+                                                     size_t result_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, predicate_func, result_count);
+}
+
+
+template <ExecutionPolicyType ExecutionPolicy, DocumentPredicate PredicateFunc>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, PredicateFunc predicate_func,
+                                                     size_t result_count) const {
+    const QueryArena::Scope query_arena;
+    return FindTopDocumentsForQuery(policy, ParseQuery(raw_query, query_arena.GetResource()), MakePredicateFilter(predicate_func),
+                                    result_count);
+}
+
+
+template <ExecutionPolicyType ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+                                                     size_t result_count) const {
+    const QueryArena::Scope query_arena;
+    const QueryWords query_words = ParseQuery(raw_query, query_arena.GetResource());
+    const auto ordinal_filter = MakeStatusFilter(status);
+    if (!result_cache_.IsEnabled()) {
+        return FindTopDocumentsForQuery(policy, query_words, ordinal_filter, result_count);
+    }
+
+    std::string key = MakeResultCacheKey(query_words, status, result_count);
+    if (std::optional<std::vector<Document>> cached_result = result_cache_.Find(key, index_generation_)) {
+        return std::move(*cached_result);
+    }
+    std::vector<Document> result = FindTopDocumentsForQuery(policy, query_words, ordinal_filter, result_count);
+    result_cache_.Insert(std::move(key), index_generation_, result);
+
+    return result;
+}
+
+
+template <ExecutionPolicyType ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                                     size_t result_count) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL, result_count);
+}
+
+
+template <DocumentPredicate PredicateFunc>
+std::vector<Document> SearchServer::FindTopDocumentsAfter(std::string_view raw_query, const Document& after, PredicateFunc predicate_func,
+                                                          size_t result_count) const {
+    const QueryArena::Scope query_arena;
+    return FindTopDocumentsForQuery(std::execution::seq, ParseQuery(raw_query, query_arena.GetResource()), MakePredicateFilter(predicate_func),
+                                    result_count, &after);
+}
+
 
-    if (result.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        result.resize(MAX_RESULT_DOCUMENT_COUNT);
+template <typename ExecutionPolicy, typename OrdinalFilter>
+std::vector<Document> SearchServer::FindTopDocumentsForQuery(ExecutionPolicy&& policy, const QueryWords& query_words,
+                                                             OrdinalFilter ordinal_filter, size_t result_count,
+                                                             const Document* after) const {
+    // Отсечение выгодно, только когда топ меньше числа документов; иначе считаются все документы
+    if constexpr (std::is_same_v<std::remove_cvref_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        if (result_count < static_cast<size_t>(document_count_)) {
+            return FindTopDocumentsPruned(query_words, ordinal_filter, result_count, after);
+        }
     }
+    std::vector<Document> result = FindAllDocuments(policy, query_words, ordinal_filter);
+    if (after != nullptr) {
+        result.erase(std::remove_if(result.begin(), result.end(),
+                                    [after](const Document& document) { return !IsMoreRelevant(*after, document); }),
+                     result.end());
+    }
+    SelectTopDocuments(policy, result, result_count);
 
     return result;
 }
 
 
+inline bool SearchServer::IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+        if (lhs.rating != rhs.rating) {
+            return lhs.rating > rhs.rating;
+        }
+        return lhs.id < rhs.id;
+    }
+    return lhs.relevance > rhs.relevance;
+}
+
+
+// Отбор result_count лучших документов частичной сортировкой: O(n log K) вместо полной сортировки
+template <typename ExecutionPolicy>
+void SearchServer::SelectTopDocuments(ExecutionPolicy&& policy, std::vector<Document>& documents, size_t result_count) {
+    TRACE_SCOPE(TraceStage::SORT_DOCUMENTS);
+    if (documents.size() > result_count) {
+        std::partial_sort(policy, documents.begin(), documents.begin() + result_count, documents.end(), IsMoreRelevant);
+        documents.resize(result_count);
+    } else {
+        std::sort(policy, documents.begin(), documents.end(), IsMoreRelevant);
+    }
+}
+
+
 template <typename StringCollection>
+    requires (!std::is_convertible_v<const StringCollection&, std::string_view>)
 SearchServer::SearchServer(const StringCollection& word_collection) {
-    for (const std::string& word : word_collection) {
+    for (const auto& word : word_collection) {
         if (!IsWordCorrect(word)) {
             throw std::invalid_argument("Stop words are incorrect");
         }
-        stop_words_.insert(word);
+        stop_words_.emplace(word);
     }
 }
 
 
-template <typename PredicateFunc>
-std::vector<Document> SearchServer::FindAllDocuments(const QueryWords& query_words, PredicateFunc predicate_func) const {
-    std::vector<Document> matched_documents_vector;
-    std::map<int, double> matched_documents;
-
-    for (const auto& [word, documents_id_tf] : documents_) {
-        if (query_words.plus_words.contains(word)) {
-            double word_idf = std::log(static_cast<double>(document_count_) / documents_.at(word).size());
-            for (const auto& [document_id, word_tf] : documents_id_tf) {
-                if (predicate_func(document_id, documents_statuses_.at(document_id), documents_ratings_.at(document_id))) {
-                    matched_documents[document_id] += word_idf * word_tf;
+// Отбор топа методом MaxScore. Списки слов обходятся одновременно по возрастанию ординала.
+// Вклад слова не больше idf * max TF; слова с наименьшими такими границами, сумма которых не дает
+// документу войти в текущий топ, становятся необязательными. Документ, встреченный только в их
+// списках, не рассматривается, а в эти списки перескакиваем через SkipTo лишь для кандидатов.
+// Вклады слов складываются в том же порядке, что и в FindAllDocuments, поэтому релевантность
+// совпадает с полным перебором бит в бит.
+template <typename OrdinalFilter>
+std::vector<Document> SearchServer::FindTopDocumentsPruned(const QueryWords& query_words, OrdinalFilter ordinal_filter,
+                                                           size_t result_count, const Document* after) const {
+    TRACE_SCOPE(TraceStage::SCORE_DOCUMENTS);
+    if (result_count == 0) {
+        return {};
+    }
+
+    struct QueryTerm {
+        PostingList::Iterator cursor;
+        PostingList::Iterator end;
+        double idf;
+        double max_score;
+    };
+    // Рабочие массивы живут в арене потока, где выполняется отбор (у шардов это потоки пула)
+    const QueryArena::Scope scratch_arena;
+    std::pmr::vector<QueryTerm> query_terms(scratch_arena.GetResource());
+    for (size_t word_index = 0; word_index < query_words.plus_words.size(); ++word_index) {
+        const int term_id = FindIndexedTerm(query_words.plus_words[word_index]);
+        if (term_id == TermDictionary::NO_TERM) {
+            continue;
+        }
+        const double idf = GetPlusWordIdf(query_words, word_index, term_id);
+        query_terms.push_back({ postings_[term_id].begin(), postings_[term_id].end(), idf, idf * terms_data_[term_id].max_term_frequency });
+    }
+    const ScoreAccumulator::Lease excluded_documents = ScoreAccumulator::Acquire(documents_.ids.size());
+    ExcludeMinusWordDocuments(query_words, *excluded_documents);
+
+    // Слова по возрастанию границы вклада; bounds[i] - сумма границ первых i + 1 слов этого порядка
+    std::pmr::vector<size_t> order(query_terms.size(), scratch_arena.GetResource());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&query_terms](size_t lhs, size_t rhs) { return query_terms[lhs].max_score < query_terms[rhs].max_score; });
+    std::pmr::vector<double> bounds(order.size(), scratch_arena.GetResource());
+    for (size_t i = 0; i < order.size(); ++i) {
+        bounds[i] = (i > 0 ? bounds[i - 1] : 0.0) + query_terms[order[i]].max_score;
+    }
+
+    // Документ с релевантностью в пределах EPSILON от худшего в топе еще может его вытеснить
+    // по рейтингу, поэтому отсекаются только границы с запасом; второй EPSILON покрывает
+    // погрешность сложения в другом порядке.
+    const auto cannot_enter_top = [](double bound, double threshold) { return bound + 2 * EPSILON < threshold; };
+
+    // Куча, в вершине которой худший документ текущего топа
+    std::vector<Document> top_documents;
+    top_documents.reserve(result_count);
+    double threshold = 0.0;
+    size_t first_essential = 0;
+    std::pmr::vector<double> contributions(query_terms.size(), scratch_arena.GetResource());
+
+    while (true) {
+        int ordinal = std::numeric_limits<int>::max();
+        for (size_t i = first_essential; i < order.size(); ++i) {
+            const QueryTerm& query_term = query_terms[order[i]];
+            if (query_term.cursor != query_term.end) {
+                ordinal = std::min(ordinal, query_term.cursor->document_id);
+            }
+        }
+        if (ordinal == std::numeric_limits<int>::max()) {
+            break;
+        }
+
+        const bool is_candidate = !excluded_documents->IsExcluded(ordinal) && ordinal_filter(ordinal);
+        const int word_count = documents_.word_counts[ordinal];
+        std::fill(contributions.begin(), contributions.end(), 0.0);
+        double score = 0.0;
+        for (size_t i = first_essential; i < order.size(); ++i) {
+            QueryTerm& query_term = query_terms[order[i]];
+            if (query_term.cursor != query_term.end && query_term.cursor->document_id == ordinal) {
+                if (is_candidate) {
+                    contributions[order[i]] = query_term.idf * query_term.cursor->term_count / word_count;
+                    score += contributions[order[i]];
                 }
+                ++query_term.cursor;
+            }
+        }
+        if (!is_candidate) {
+            continue;
+        }
+
+        const bool is_top_full = top_documents.size() == result_count;
+        bool is_pruned = false;
+        for (size_t i = first_essential; i-- > 0;) {
+            if (is_top_full && cannot_enter_top(score + bounds[i], threshold)) {
+                is_pruned = true;
+                break;
+            }
+            QueryTerm& query_term = query_terms[order[i]];
+            query_term.cursor.SkipTo(ordinal);
+            if (query_term.cursor != query_term.end && query_term.cursor->document_id == ordinal) {
+                contributions[order[i]] = query_term.idf * query_term.cursor->term_count / word_count;
+                score += contributions[order[i]];
+            }
+        }
+        if (is_pruned) {
+            continue;
+        }
+
+        double relevance = 0.0;
+        for (const double contribution : contributions) {
+            relevance += contribution;
+        }
+        const Document candidate{ documents_.ids[ordinal], relevance, documents_.ratings[ordinal] };
+        if (after != nullptr && !IsMoreRelevant(*after, candidate)) {
+            continue;
+        }
+        if (!is_top_full) {
+            top_documents.push_back(candidate);
+            std::push_heap(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+        } else if (IsMoreRelevant(candidate, top_documents.front())) {
+            std::pop_heap(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+            top_documents.back() = candidate;
+            std::push_heap(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+        } else {
+            continue;
+        }
+
+        if (top_documents.size() == result_count) {
+            threshold = top_documents.front().relevance;
+            while (first_essential < order.size() && cannot_enter_top(bounds[first_essential], threshold)) {
+                ++first_essential;
             }
         }
     }
 
-    for (const std::string& minus_word : query_words.minus_words) {
-        if (documents_.contains(minus_word)) {
-            for (const auto& [document_id, word_tf] : documents_.at(minus_word)) {
-                if (matched_documents.contains(document_id)) {
-                    matched_documents.erase(document_id);
-                }
+    std::sort(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+    return top_documents;
+}
+
+
+template <typename OrdinalFilter>
+std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
+                                                     const QueryWords& query_words, OrdinalFilter ordinal_filter) const {
+    TRACE_SCOPE(TraceStage::SCORE_DOCUMENTS);
+    const ScoreAccumulator::Lease accumulator = ScoreAccumulator::Acquire(documents_.ids.size());
+    ExcludeMinusWordDocuments(query_words, *accumulator);
+
+    for (size_t word_index = 0; word_index < query_words.plus_words.size(); ++word_index) {
+        const int term_id = FindIndexedTerm(query_words.plus_words[word_index]);
+        if (term_id == TermDictionary::NO_TERM) {
+            continue;
+        }
+        const double word_idf = GetPlusWordIdf(query_words, word_index, term_id);
+        for (const auto [ordinal, term_count] : postings_[term_id]) {
+            if (!accumulator->IsExcluded(ordinal) && ordinal_filter(ordinal)) {
+                accumulator->Add(ordinal, word_idf * term_count / documents_.word_counts[ordinal]);
             }
         }
     }
 
-    for (const auto& [document_id, relevance] : matched_documents) {
-        matched_documents_vector.push_back(Document{ document_id, relevance, documents_ratings_.at(document_id) });
+    std::vector<Document> matched_documents_vector;
+    matched_documents_vector.reserve(accumulator->GetTouched().size());
+    for (const int ordinal : accumulator->GetTouched()) {
+        matched_documents_vector.push_back(Document{ documents_.ids[ordinal], accumulator->GetScore(ordinal), documents_.ratings[ordinal] });
+    }
+
+    return matched_documents_vector;
+}
+
+
+template <typename OrdinalFilter>
+std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy& policy,
+                                                     const QueryWords& query_words, OrdinalFilter ordinal_filter) const {
+    TRACE_SCOPE(TraceStage::SCORE_DOCUMENTS);
+    ConcurrentMap<int, double> matched_documents(CONCURRENT_BUCKET_COUNT);
+    // Карта исключенных строится заранее в этом потоке, задачи только читают ее
+    const ScoreAccumulator::Lease excluded_documents = ScoreAccumulator::Acquire(documents_.ids.size());
+    ExcludeMinusWordDocuments(query_words, *excluded_documents);
+
+    // IDF зависит от номера слова в запросе, поэтому пары (слово, IDF) собираются заранее:
+    // параллельный алгоритм может передавать задачам копии элементов, и номер по адресу не восстановить
+    struct QueryTerm {
+        int term_id;
+        double idf;
+    };
+    const QueryArena::Scope scratch_arena;
+    std::pmr::vector<QueryTerm> query_terms(scratch_arena.GetResource());
+    for (size_t word_index = 0; word_index < query_words.plus_words.size(); ++word_index) {
+        const int term_id = FindIndexedTerm(query_words.plus_words[word_index]);
+        if (term_id != TermDictionary::NO_TERM) {
+            query_terms.push_back({ term_id, GetPlusWordIdf(query_words, word_index, term_id) });
+        }
+    }
+
+    std::for_each(policy, query_terms.begin(), query_terms.end(),
+        [this, &matched_documents, &ordinal_filter, &excluded_documents](const QueryTerm& query_term) {
+            for (const auto [ordinal, term_count] : postings_[query_term.term_id]) {
+                if (!excluded_documents->IsExcluded(ordinal) && ordinal_filter(ordinal)) {
+                    matched_documents[ordinal].ref_to_value += query_term.idf * term_count / documents_.word_counts[ordinal];
+                }
+            }
+        });
+
+    std::vector<Document> matched_documents_vector;
+    for (const auto& [ordinal, relevance] : matched_documents.BuildOrdinaryMap()) {
+        matched_documents_vector.push_back(Document{ documents_.ids[ordinal], relevance, documents_.ratings[ordinal] });
     }
 
     return matched_documents_vector;
@@ -0,0 +1,573 @@
+#include "search_server_benchmark.h"
+#include "allocation_counter.h"
+#include "document_loader.h"
+#include "log_duration.h"
+#include "process_queries.h"
+#include "score_accumulator.h"
+#include "sharded_search_server.h"
+
+#include <chrono>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+mt19937 generator(42);
+
+
+vector<string> GenerateDictionary(int word_count, int max_word_length) {
+    vector<string> words;
+    words.reserve(word_count);
+    for (int i = 0; i < word_count; ++i) {
+        const int length = uniform_int_distribution<int>(1, max_word_length)(generator);
+        string word(length, ' ');
+        for (char& c : word) {
+            c = static_cast<char>(uniform_int_distribution<int>('a', 'z')(generator));
+        }
+        words.push_back(word + to_string(i));
+    }
+
+    return words;
+}
+
+
+string GenerateDocument(const vector<string>& dictionary, int word_count) {
+    string document;
+    for (int i = 0; i < word_count; ++i) {
+        if (i > 0) {
+            document.push_back(' ');
+        }
+        document += dictionary[uniform_int_distribution<int>(0, static_cast<int>(dictionary.size()) - 1)(generator)];
+    }
+
+    return document;
+}
+
+} // namespace
+
+
+void BenchmarkQueryLatencyByVocabularySize() {
+    // Документы, по которым ищут запросы, одинаковы для всех прогонов;
+    // растет только словарь за счет документов из уникальных слов.
+    const vector<string> query_dictionary = GenerateDictionary(1'000, 8);
+    vector<string> matching_documents;
+    for (int i = 0; i < 2'000; ++i) {
+        matching_documents.push_back(GenerateDocument(query_dictionary, 10));
+    }
+    vector<string> queries;
+    for (int i = 0; i < 1'000; ++i) {
+        queries.push_back(GenerateDocument(query_dictionary, 2));
+    }
+
+    const int filler_words_per_document = 10;
+    for (const int vocabulary_size : {10'000, 100'000, 1'000'000}) {
+        SearchServer search_server("and in at"s);
+        int document_id = 0;
+        for (const string& document : matching_documents) {
+            search_server.AddDocument(document_id++, document, DocumentStatus::ACTUAL, {1, 2, 3});
+        }
+        for (int word = 0; word < vocabulary_size; word += filler_words_per_document) {
+            string document;
+            for (int i = word; i < word + filler_words_per_document; ++i) {
+                document += "filler"s + to_string(i) + ' ';
+            }
+            search_server.AddDocument(document_id++, document, DocumentStatus::ACTUAL, {1, 2, 3});
+        }
+
+        size_t total_found = 0;
+        const auto start_time = chrono::steady_clock::now();
+        for (const string& query : queries) {
+            total_found += search_server.FindTopDocuments(query).size();
+        }
+        const auto duration = chrono::steady_clock::now() - start_time;
+        cerr << "Vocabulary ~" << vocabulary_size << " words: "
+             << chrono::duration_cast<chrono::microseconds>(duration).count() / static_cast<double>(queries.size())
+             << " us per query (found " << total_found << ")" << endl;
+    }
+}
+
+
+void BenchmarkProcessQueries() {
+    const vector<string> dictionary = GenerateDictionary(2'000, 25);
+    SearchServer search_server(dictionary[0]);
+    for (int i = 0; i < 20'000; ++i) {
+        search_server.AddDocument(i, GenerateDocument(dictionary, 10), DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    vector<string> queries;
+    for (int i = 0; i < 2'000; ++i) {
+        queries.push_back(GenerateDocument(dictionary, 7));
+    }
+
+    size_t total_found = 0;
+    {
+        LOG_DURATION("Sequential loop over "s + to_string(queries.size()) + " queries"s);
+        for (const string& query : queries) {
+            total_found += search_server.FindTopDocuments(query).size();
+        }
+    }
+    {
+        LOG_DURATION("ProcessQueries over "s + to_string(queries.size()) + " queries"s);
+        for (const vector<Document>& documents : ProcessQueries(search_server, queries)) {
+            total_found -= documents.size();
+        }
+    }
+    {
+        LOG_DURATION("ProcessQueriesJoined over "s + to_string(queries.size()) + " queries"s);
+        total_found += ProcessQueriesJoined(search_server, queries).size();
+    }
+    cerr << "Found " << total_found << " documents per pass" << endl;
+}
+
+
+void BenchmarkIndexMemoryAndQueryLatency() {
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    vector<string> documents;
+    for (int i = 0; i < 50'000; ++i) {
+        documents.push_back(GenerateDocument(dictionary, 20));
+    }
+    vector<string> queries;
+    for (int i = 0; i < 5'000; ++i) {
+        queries.push_back(GenerateDocument(dictionary, 3) + " -"s + GenerateDocument(dictionary, 1));
+    }
+
+    const size_t bytes_before = GetAllocatedBytes();
+    SearchServer search_server("and in at"s);
+    for (int i = 0; i < static_cast<int>(documents.size()); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    const size_t index_bytes = GetAllocatedBytes() - bytes_before;
+    if constexpr (ALLOCATION_COUNTING_ENABLED) {
+        cerr << "Index of " << documents.size() << " documents: "
+             << index_bytes / static_cast<double>(documents.size()) << " bytes per document" << endl;
+    }
+    const IndexMemoryUsage memory_usage = search_server.GetMemoryUsage();
+    cerr << "GetMemoryUsage: postings " << memory_usage.postings << " B, terms " << memory_usage.terms
+         << " B, documents " << memory_usage.documents << " B, total "
+         << memory_usage.GetTotal() / static_cast<double>(documents.size()) << " bytes per document" << endl;
+
+    size_t total_found = 0;
+    const auto start_time = chrono::steady_clock::now();
+    for (const string& query : queries) {
+        total_found += search_server.FindTopDocuments(query).size();
+    }
+    const auto duration = chrono::steady_clock::now() - start_time;
+    cerr << "Query latency: "
+         << chrono::duration_cast<chrono::microseconds>(duration).count() / static_cast<double>(queries.size())
+         << " us per query (found " << total_found << ")" << endl;
+}
+
+
+void BenchmarkSnapshotLoad() {
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    vector<string> documents;
+    for (int i = 0; i < 50'000; ++i) {
+        documents.push_back(GenerateDocument(dictionary, 20));
+    }
+
+    SearchServer search_server("and in at"s);
+    {
+        LOG_DURATION("Rebuild index of "s + to_string(documents.size()) + " documents"s);
+        for (int i = 0; i < static_cast<int>(documents.size()); ++i) {
+            search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+        }
+    }
+    const string path = (filesystem::temp_directory_path() / "search_server_benchmark_snapshot.bin"s).string();
+    {
+        LOG_DURATION("SaveSnapshot"s);
+        search_server.SaveSnapshot(path);
+    }
+    {
+        LOG_DURATION("LoadSnapshot"s);
+        const SearchServer loaded = SearchServer::LoadSnapshot(path);
+        cerr << "Loaded " << loaded.GetDocumentCount() << " documents" << endl;
+    }
+    filesystem::remove(path);
+}
+
+
+void BenchmarkBulkIngestion() {
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    vector<string> contents;
+    for (int i = 0; i < 50'000; ++i) {
+        contents.push_back(GenerateDocument(dictionary, 20));
+    }
+    vector<RawDocument> documents;
+    for (int i = 0; i < static_cast<int>(contents.size()); ++i) {
+        documents.push_back({ i, contents[i], DocumentStatus::ACTUAL, {1, 2, 3} });
+    }
+
+    {
+        SearchServer search_server("and in at"s);
+        LOG_DURATION("AddDocument loop over "s + to_string(documents.size()) + " documents"s);
+        for (const RawDocument& document : documents) {
+            search_server.AddDocument(document.id, document.content, document.status, document.ratings);
+        }
+    }
+    {
+        SearchServer search_server("and in at"s);
+        LOG_DURATION("AddDocuments(seq) over "s + to_string(documents.size()) + " documents"s);
+        search_server.AddDocuments(execution::seq, documents);
+    }
+    {
+        SearchServer search_server("and in at"s);
+        LOG_DURATION("AddDocuments(par) over "s + to_string(documents.size()) + " documents"s);
+        search_server.AddDocuments(execution::par, documents);
+    }
+}
+
+
+void BenchmarkResultCache() {
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    SearchServer search_server("and in at"s);
+    for (int i = 0; i < 50'000; ++i) {
+        search_server.AddDocument(i, GenerateDocument(dictionary, 20), DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    vector<string> distinct_queries;
+    for (int i = 0; i < 1'000; ++i) {
+        distinct_queries.push_back(GenerateDocument(dictionary, 3));
+    }
+    // Первые запросы встречаются намного чаще остальных
+    vector<string> queries;
+    geometric_distribution<int> query_rank(0.05);
+    for (int i = 0; i < 20'000; ++i) {
+        queries.push_back(distinct_queries[min(query_rank(generator), static_cast<int>(distinct_queries.size()) - 1)]);
+    }
+
+    for (const size_t capacity : {0, 100}) {
+        search_server.SetResultCacheCapacity(capacity);
+        LOG_DURATION("Skewed queries with cache capacity "s + to_string(capacity));
+        for (const string& query : queries) {
+            search_server.FindTopDocuments(query);
+        }
+    }
+    const ResultCacheStats stats = search_server.GetResultCacheStats();
+    cerr << "Result cache: " << stats.hits << " hits, " << stats.misses << " misses" << endl;
+}
+
+
+void BenchmarkTopDocumentsPruning() {
+    // Частоты слов неравномерны: частые слова дают длинные списки с малым idf
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    uniform_int_distribution<int> word_index(0, static_cast<int>(dictionary.size()) - 1);
+    const auto generate_skewed_document = [&](int word_count) {
+        string document;
+        for (int i = 0; i < word_count; ++i) {
+            document += dictionary[min({word_index(generator), word_index(generator), word_index(generator)})] + ' ';
+        }
+        return document;
+    };
+
+    const int document_count = 50'000;
+    SearchServer search_server("and in at"s);
+    for (int i = 0; i < document_count; ++i) {
+        search_server.AddDocument(i, generate_skewed_document(20), DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+
+    for (const int query_word_count : {2, 4, 8}) {
+        vector<string> queries;
+        for (int i = 0; i < 500; ++i) {
+            queries.push_back(generate_skewed_document(query_word_count));
+        }
+        {
+            LOG_DURATION(to_string(query_word_count) + "-word queries, exhaustive"s);
+            for (const string& query : queries) {
+                search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, document_count);
+            }
+        }
+        {
+            LOG_DURATION(to_string(query_word_count) + "-word queries, MaxScore top-"s + to_string(MAX_RESULT_DOCUMENT_COUNT));
+            for (const string& query : queries) {
+                search_server.FindTopDocuments(query);
+            }
+        }
+    }
+}
+
+
+// Только шаг накопления оценок: списки плюс- и минус-слов заранее декодированы
+void BenchmarkScoreAccumulation() {
+    const int ordinal_count = 50'000;
+    uniform_int_distribution<int> ordinal_distribution(0, ordinal_count - 1);
+    const auto generate_postings = [&](int size) {
+        vector<int> postings(size);
+        for (int& ordinal : postings) {
+            ordinal = ordinal_distribution(generator);
+        }
+        sort(postings.begin(), postings.end());
+        postings.erase(unique(postings.begin(), postings.end()), postings.end());
+        return postings;
+    };
+    vector<vector<int>> plus_postings;
+    for (int i = 0; i < 8; ++i) {
+        plus_postings.push_back(generate_postings(5'000));
+    }
+    vector<vector<int>> minus_postings;
+    for (int i = 0; i < 2; ++i) {
+        minus_postings.push_back(generate_postings(2'000));
+    }
+    const int repeat_count = 200;
+
+    size_t total_matched = 0;
+    {
+        LOG_DURATION("std::map accumulation with erase, "s + to_string(repeat_count) + " queries"s);
+        for (int repeat = 0; repeat < repeat_count; ++repeat) {
+            map<int, double> scores;
+            for (const vector<int>& postings : plus_postings) {
+                for (const int ordinal : postings) {
+                    scores[ordinal] += 0.5;
+                }
+            }
+            for (const vector<int>& postings : minus_postings) {
+                for (const int ordinal : postings) {
+                    scores.erase(ordinal);
+                }
+            }
+            total_matched += scores.size();
+        }
+    }
+    {
+        LOG_DURATION("ScoreAccumulator with exclusion bitmap, "s + to_string(repeat_count) + " queries"s);
+        for (int repeat = 0; repeat < repeat_count; ++repeat) {
+            const ScoreAccumulator::Lease accumulator = ScoreAccumulator::Acquire(ordinal_count);
+            for (const vector<int>& postings : minus_postings) {
+                for (const int ordinal : postings) {
+                    accumulator->Exclude(ordinal);
+                }
+            }
+            for (const vector<int>& postings : plus_postings) {
+                for (const int ordinal : postings) {
+                    if (!accumulator->IsExcluded(ordinal)) {
+                        accumulator->Add(ordinal, 0.5);
+                    }
+                }
+            }
+            total_matched -= accumulator->GetTouched().size();
+        }
+    }
+    cerr << "Matched count difference: " << total_matched << endl;
+}
+
+
+// Страница page_number по 10 документов: срез большого топа против продолжения с курсора
+void BenchmarkDeepPaging() {
+    const vector<string> dictionary = GenerateDictionary(2'000, 10);
+    SearchServer search_server("and in at"s);
+    for (int i = 0; i < 50'000; ++i) {
+        search_server.AddDocument(i, GenerateDocument(dictionary, 20), DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    vector<string> queries;
+    for (int i = 0; i < 200; ++i) {
+        queries.push_back(GenerateDocument(dictionary, 3));
+    }
+
+    const size_t page_size = 10;
+    for (const size_t page_number : {10, 100}) {
+        // Курсоры - последние документы предыдущих страниц, как если бы их прислал клиент
+        vector<Document> cursors;
+        for (const string& query : queries) {
+            const vector<Document> previous_pages = search_server.FindTopDocuments(query, page_number * page_size);
+            cursors.push_back(previous_pages.empty() ? Document() : previous_pages.back());
+        }
+
+        size_t sliced_count = 0;
+        {
+            LOG_DURATION("Page "s + to_string(page_number) + ", slice of top-"s + to_string((page_number + 1) * page_size));
+            for (const string& query : queries) {
+                const vector<Document> documents = search_server.FindTopDocuments(query, (page_number + 1) * page_size);
+                sliced_count += documents.size() - min(documents.size(), page_number * page_size);
+            }
+        }
+        size_t cursor_count = 0;
+        {
+            LOG_DURATION("Page "s + to_string(page_number) + ", FindTopDocumentsAfter"s);
+            for (size_t i = 0; i < queries.size(); ++i) {
+                cursor_count += search_server.FindTopDocumentsAfter(queries[i], cursors[i], page_size).size();
+            }
+        }
+        cerr << "Documents on page: " << sliced_count << " vs " << cursor_count << endl;
+    }
+}
+
+
+void BenchmarkShardedSearch() {
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    vector<string> contents;
+    for (int i = 0; i < 50'000; ++i) {
+        contents.push_back(GenerateDocument(dictionary, 20));
+    }
+    vector<RawDocument> documents;
+    for (int i = 0; i < static_cast<int>(contents.size()); ++i) {
+        documents.push_back({ i, contents[i], DocumentStatus::ACTUAL, {1, 2, 3} });
+    }
+    vector<string> queries;
+    for (int i = 0; i < 2'000; ++i) {
+        queries.push_back(GenerateDocument(dictionary, 3));
+    }
+
+    SearchServer search_server("and in at"s);
+    {
+        LOG_DURATION("AddDocuments, single index"s);
+        search_server.AddDocuments(documents);
+    }
+    for (const size_t shard_count : {2, 8}) {
+        ShardedSearchServer sharded_server("and in at"s, shard_count);
+        {
+            LOG_DURATION("AddDocuments, "s + to_string(shard_count) + " shards"s);
+            sharded_server.AddDocuments(documents);
+        }
+        size_t found_count = 0;
+        {
+            LOG_DURATION("FindTopDocuments, "s + to_string(shard_count) + " shards"s);
+            for (const string& query : queries) {
+                found_count += sharded_server.FindTopDocuments(query).size();
+            }
+        }
+        cerr << "Found " << found_count << " documents" << endl;
+    }
+    size_t found_count = 0;
+    {
+        LOG_DURATION("FindTopDocuments, single index"s);
+        for (const string& query : queries) {
+            found_count += search_server.FindTopDocuments(query).size();
+        }
+    }
+    cerr << "Found " << found_count << " documents" << endl;
+}
+
+
+// Обращения к куче на документ и на запрос; временные данные запроса и разбиения документа
+// на слова размещаются в арене потока, поэтому на запрос остается выделение под результат
+void BenchmarkAllocations() {
+    if constexpr (!ALLOCATION_COUNTING_ENABLED) {
+        cerr << "Allocation counting is disabled, rebuild with -DSEARCH_SERVER_COUNT_ALLOCATIONS" << endl;
+        return;
+    }
+    const vector<string> dictionary = GenerateDictionary(5'000, 10);
+    vector<string> documents;
+    for (int i = 0; i < 50'000; ++i) {
+        documents.push_back(GenerateDocument(dictionary, 20));
+    }
+    vector<string> queries;
+    for (int i = 0; i < 5'000; ++i) {
+        queries.push_back(GenerateDocument(dictionary, 4) + " -"s + GenerateDocument(dictionary, 1));
+    }
+
+    const size_t rss_before = GetResidentSetSize();
+    SearchServer search_server("and in at"s);
+    size_t allocations_before = GetAllocationCount();
+    for (int i = 0; i < static_cast<int>(documents.size()); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    cerr << "AddDocument: " << (GetAllocationCount() - allocations_before) / static_cast<double>(documents.size())
+         << " allocations per document, RSS " << rss_before / 1024 << " -> " << GetResidentSetSize() / 1024 << " KiB" << endl;
+
+    const auto count_query_allocations = [&](const string& name, const auto& run_query) {
+        run_query(queries.front());
+        const size_t rss_before_queries = GetResidentSetSize();
+        const size_t allocations_before_queries = GetAllocationCount();
+        for (const string& query : queries) {
+            run_query(query);
+        }
+        cerr << name << ": " << (GetAllocationCount() - allocations_before_queries) / static_cast<double>(queries.size())
+             << " allocations per query, RSS " << rss_before_queries / 1024 << " -> " << GetResidentSetSize() / 1024 << " KiB" << endl;
+    };
+    count_query_allocations("FindTopDocuments top-5"s, [&](const string& query) { search_server.FindTopDocuments(query); });
+    count_query_allocations("FindTopDocuments all"s,
+                            [&](const string& query) { search_server.FindTopDocuments(query, documents.size()); });
+    count_query_allocations("MatchDocument"s, [&](const string& query) { search_server.MatchDocument(query, 42); });
+}
+
+
+// Загрузка корпуса из файла: построчное чтение с разбором и AddDocument против конвейера LoadDocuments
+void BenchmarkFileIngestion() {
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    const string path = (filesystem::temp_directory_path() / "search_server_benchmark_corpus.tsv"s).string();
+    {
+        ofstream output(path, ios::binary | ios::trunc);
+        for (int i = 0; i < 200'000; ++i) {
+            output << i << "\tACTUAL\t1 2 3\t"s << GenerateDocument(dictionary, 20) << '\n';
+        }
+    }
+    const double megabytes = static_cast<double>(filesystem::file_size(path)) / (1024 * 1024);
+
+    const auto report = [megabytes](const string& name, const auto& load) {
+        const auto start = chrono::steady_clock::now();
+        const int document_count = load();
+        const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        cerr << name << ": "s << document_count << " documents, "s << megabytes / elapsed.count() << " MB/s"s << endl;
+    };
+    report("getline + AddDocument"s, [&path] {
+        SearchServer search_server("and in at"s);
+        ifstream input(path, ios::binary);
+        string line;
+        while (getline(input, line)) {
+            const size_t id_end = line.find('\t');
+            const size_t status_end = line.find('\t', id_end + 1);
+            const size_t ratings_end = line.find('\t', status_end + 1);
+            vector<int> ratings;
+            istringstream ratings_input(line.substr(status_end + 1, ratings_end - status_end - 1));
+            for (int rating; ratings_input >> rating;) {
+                ratings.push_back(rating);
+            }
+            search_server.AddDocument(stoi(line.substr(0, id_end)), string_view(line).substr(ratings_end + 1), DocumentStatus::ACTUAL,
+                                      ratings);
+        }
+        return search_server.GetDocumentCount();
+    });
+    for (const size_t worker_count : {size_t{1}, size_t{4}}) {
+        report("LoadDocuments, "s + to_string(worker_count) + " workers"s, [&path, worker_count] {
+            SearchServer search_server("and in at"s);
+            DocumentLoaderConfig config;
+            config.worker_count = worker_count;
+            LoadDocuments(search_server, path, config);
+            return search_server.GetDocumentCount();
+        });
+    }
+    filesystem::remove(path);
+}
+
+// Удаление документов с общим частым словом: стоимость не должна зависеть от длины его списка
+void BenchmarkRemoveDocument() {
+    const vector<string> dictionary = GenerateDictionary(20'000, 10);
+    SearchServer search_server("and in at"s);
+    vector<RawDocument> documents;
+    vector<string> contents;
+    for (int i = 0; i < 200'000; ++i) {
+        contents.push_back("common "s + GenerateDocument(dictionary, 10));
+    }
+    for (int i = 0; i < static_cast<int>(contents.size()); ++i) {
+        documents.push_back({ i, contents[i], DocumentStatus::ACTUAL, {1, 2, 3} });
+    }
+    search_server.AddDocuments(documents);
+    {
+        LOG_DURATION("RemoveDocument x200 on 200k documents sharing a word"s);
+        for (int i = 0; i < 200; ++i) {
+            search_server.RemoveDocument(i * 997);
+        }
+    }
+    cerr << "Documents left: " << search_server.GetDocumentCount() << endl;
+}
+
+
+void BenchmarkSearchServer() {
+    BenchmarkQueryLatencyByVocabularySize();
+    BenchmarkProcessQueries();
+    BenchmarkIndexMemoryAndQueryLatency();
+    BenchmarkSnapshotLoad();
+    BenchmarkBulkIngestion();
+    BenchmarkResultCache();
+    BenchmarkTopDocumentsPruning();
+    BenchmarkScoreAccumulation();
+    BenchmarkDeepPaging();
+    BenchmarkShardedSearch();
+    BenchmarkAllocations();
+    BenchmarkFileIngestion();
+    BenchmarkRemoveDocument();
+}
\ No newline at end of file
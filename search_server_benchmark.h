@@ -0,0 +1,30 @@
+#pragma once
+#include "search_server.h"
+
+void BenchmarkQueryLatencyByVocabularySize();
+
+void BenchmarkProcessQueries();
+
+void BenchmarkIndexMemoryAndQueryLatency();
+
+void BenchmarkSnapshotLoad();
+
+void BenchmarkBulkIngestion();
+
+void BenchmarkResultCache();
+
+void BenchmarkTopDocumentsPruning();
+
+void BenchmarkScoreAccumulation();
+
+void BenchmarkDeepPaging();
+
+void BenchmarkShardedSearch();
+
+void BenchmarkAllocations();
+
+void BenchmarkFileIngestion();
+
+void BenchmarkRemoveDocument();
+
+void BenchmarkSearchServer();
\ No newline at end of file
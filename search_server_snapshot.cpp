@@ -0,0 +1,281 @@
+#include "search_server.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+// Формат снимка (порядок байт машины, на которой он записан):
+//   заголовок: магическое число, версия, маркер порядка байт;
+//   стоп-слова и словарь терминов в порядке ID: длина и байты каждого слова;
+//   столбцы документов по ординалу: ID, рейтинги, статусы, числа слов и признаки того,
+//   что документ не удален;
+//   прямой индекс: для каждого ординала массив пар (ID термина, число вхождений);
+//   списки документов: размер, последний ординал, выровненная таблица пропусков и сжатые данные.
+
+namespace {
+
+const std::uint64_t SNAPSHOT_MAGIC = 0x50414E5348435253;  // "SRCHSNAP"
+const std::uint32_t SNAPSHOT_VERSION = 2;
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(const std::string& path)
+        : output_(path, std::ios::binary | std::ios::trunc) {
+        if (!output_) {
+            throw std::runtime_error("Can't create snapshot " + path);
+        }
+    }
+
+    template <typename T>
+    void Write(const T& value) {
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void WriteString(std::string_view text) {
+        Write(static_cast<std::uint32_t>(text.size()));
+        WriteBytes(text.data(), text.size());
+    }
+
+    template <typename T>
+    void WriteArray(std::span<const T> values) {
+        Align(alignof(T));
+        WriteBytes(values.data(), values.size_bytes());
+    }
+
+    void WriteBytes(const void* data, size_t size) {
+        output_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position_ += size;
+    }
+
+    void Finish() {
+        output_.flush();
+        if (!output_) {
+            throw std::runtime_error("Can't write snapshot");
+        }
+    }
+
+private:
+    std::ofstream output_;
+    size_t position_ = 0;
+
+    void Align(size_t alignment) {
+        static const char padding[alignof(std::max_align_t)] = {};
+        if (const size_t rest = position_ % alignment; rest != 0) {
+            WriteBytes(padding, alignment - rest);
+        }
+    }
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::span<const std::uint8_t> data)
+        : data_(data) {}
+
+    template <typename T>
+    T Read() {
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string_view ReadString() {
+        const std::uint32_t size = Read<std::uint32_t>();
+        return { reinterpret_cast<const char*>(Take(size)), size };
+    }
+
+    // Массив читается без копирования, поэтому его начало выровнено при записи
+    template <typename T>
+    std::span<const T> ReadArray(size_t count) {
+        if (const size_t rest = offset_ % alignof(T); rest != 0) {
+            Take(alignof(T) - rest);
+        }
+        if (count > (data_.size() - offset_) / sizeof(T)) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        return { reinterpret_cast<const T*>(Take(count * sizeof(T))), count };
+    }
+
+private:
+    std::span<const std::uint8_t> data_;
+    size_t offset_ = 0;
+
+    const std::uint8_t* Take(size_t size) {
+        if (size > data_.size() - offset_) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        const std::uint8_t* result = data_.data() + offset_;
+        offset_ += size;
+        return result;
+    }
+};
+
+} // namespace
+
+
+void SearchServer::SaveSnapshot(const std::string& path) const {
+    SnapshotWriter writer(path);
+    writer.Write(SNAPSHOT_MAGIC);
+    writer.Write(SNAPSHOT_VERSION);
+    writer.Write(BYTE_ORDER_MARK);
+
+    writer.Write(static_cast<std::uint64_t>(stop_words_.size()));
+    for (const std::string& stop_word : stop_words_) {
+        writer.WriteString(stop_word);
+    }
+    writer.Write(static_cast<std::uint64_t>(terms_.GetTermCount()));
+    for (int term_id = 0; term_id < terms_.GetTermCount(); ++term_id) {
+        writer.WriteString(terms_.GetTerm(term_id));
+    }
+
+    std::vector<std::uint8_t> is_alive(documents_.ids.size());
+    for (const auto& [document_id, ordinal] : document_ordinals_) {
+        is_alive[ordinal] = 1;
+    }
+    writer.Write(static_cast<std::uint64_t>(documents_.ids.size()));
+    writer.WriteArray(std::span<const int>(documents_.ids));
+    writer.WriteArray(std::span<const int>(documents_.ratings));
+    writer.WriteArray(std::span<const DocumentStatus>(documents_.statuses));
+    writer.WriteArray(std::span<const int>(documents_.word_counts));
+    writer.WriteArray(std::span<const std::uint8_t>(is_alive));
+    for (const std::vector<DocumentTerm>& document_terms : documents_.terms) {
+        writer.Write(static_cast<std::uint64_t>(document_terms.size()));
+        writer.WriteArray(std::span<const DocumentTerm>(document_terms));
+    }
+
+    writer.Write(static_cast<std::uint64_t>(postings_.size()));
+    for (const PostingList& stored_postings : postings_) {
+        // Удаленные записи в снимок не попадают: загруженные списки всегда плотные
+        std::optional<PostingList> compacted_postings;
+        if (stored_postings.HasRemovedEntries()) {
+            compacted_postings.emplace(stored_postings);
+            compacted_postings->Compact();
+        }
+        const PostingList& postings = compacted_postings ? *compacted_postings : stored_postings;
+        const std::span<const PostingList::SkipEntry> skips = postings.GetSkips();
+        const std::span<const std::uint8_t> bytes = postings.GetBytes();
+        writer.Write(static_cast<std::int32_t>(postings.size()));
+        writer.Write(static_cast<std::int32_t>(postings.GetLastDocumentId()));
+        writer.Write(static_cast<std::uint64_t>(skips.size()));
+        writer.Write(static_cast<std::uint64_t>(bytes.size()));
+        writer.WriteArray(skips);
+        writer.WriteArray(bytes);
+    }
+    writer.Finish();
+}
+
+
+SearchServer SearchServer::LoadSnapshot(const std::string& path) {
+    SearchServer server;
+    server.snapshot_file_ = std::make_shared<const MappedFile>(path);
+    SnapshotReader reader(server.snapshot_file_->GetData());
+
+    if (reader.Read<std::uint64_t>() != SNAPSHOT_MAGIC) {
+        throw std::runtime_error("File " + path + " is not a search server snapshot");
+    }
+    if (reader.Read<std::uint32_t>() != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Snapshot " + path + " has unsupported version");
+    }
+    if (reader.Read<std::uint32_t>() != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Snapshot " + path + " was written with another byte order");
+    }
+
+    const std::uint64_t stop_word_count = reader.Read<std::uint64_t>();
+    for (std::uint64_t i = 0; i < stop_word_count; ++i) {
+        server.stop_words_.emplace(reader.ReadString());
+    }
+    const std::uint64_t term_count = reader.Read<std::uint64_t>();
+    for (std::uint64_t term_id = 0; term_id < term_count; ++term_id) {
+        if (server.terms_.AddTerm(reader.ReadString()) != static_cast<int>(term_id)) {
+            throw std::runtime_error("Snapshot " + path + " contains duplicate terms");
+        }
+    }
+    server.terms_data_.resize(term_count);
+
+    const std::uint64_t ordinal_count = reader.Read<std::uint64_t>();
+    const std::span<const int> ids = reader.ReadArray<int>(ordinal_count);
+    const std::span<const int> ratings = reader.ReadArray<int>(ordinal_count);
+    const std::span<const DocumentStatus> statuses = reader.ReadArray<DocumentStatus>(ordinal_count);
+    const std::span<const int> word_counts = reader.ReadArray<int>(ordinal_count);
+    const std::span<const std::uint8_t> is_alive = reader.ReadArray<std::uint8_t>(ordinal_count);
+    size_t live_term_count = 0;
+    for (std::uint64_t ordinal = 0; ordinal < ordinal_count; ++ordinal) {
+        if (static_cast<size_t>(statuses[ordinal]) >= DOCUMENT_STATUS_COUNT) {
+            throw std::runtime_error("Snapshot " + path + " contains unknown document status");
+        }
+        if (ids[ordinal] < 0) {
+            throw std::runtime_error("Snapshot " + path + " contains negative document IDs");
+        }
+        if (server.document_ordinals_.contains(ids[ordinal])) {
+            throw std::runtime_error("Snapshot " + path + " contains duplicate document IDs");
+        }
+        const std::span<const DocumentTerm> document_terms = reader.ReadArray<DocumentTerm>(reader.Read<std::uint64_t>());
+        // Термины документа идут по возрастанию ID слова: по ним ищет FindDocumentTerm
+        std::int64_t term_count_sum = 0;
+        for (size_t i = 0; i < document_terms.size(); ++i) {
+            if (document_terms[i].term_id < 0 || static_cast<std::uint64_t>(document_terms[i].term_id) >= term_count
+                || document_terms[i].term_count <= 0 || (i > 0 && document_terms[i - 1].term_id >= document_terms[i].term_id)) {
+                throw std::runtime_error("Snapshot " + path + " contains invalid document terms");
+            }
+            term_count_sum += document_terms[i].term_count;
+        }
+        // Число слов документа - сумма чисел вхождений его терминов, на него делится TF.
+        // Термины удаленного документа не сохраняются.
+        if (word_counts[ordinal] < 0 || (!document_terms.empty() && term_count_sum != word_counts[ordinal])
+            || (!is_alive[ordinal] && !document_terms.empty())) {
+            throw std::runtime_error("Snapshot " + path + " is inconsistent");
+        }
+        if (is_alive[ordinal]) {
+            live_term_count += document_terms.size();
+        }
+        server.AppendDocument(ids[ordinal], ratings[ordinal], statuses[ordinal], word_counts[ordinal],
+                              std::vector<DocumentTerm>(document_terms.begin(), document_terms.end()));
+        // Удаленный документ занимает ординал, но не участвует в поиске
+        if (!is_alive[ordinal]) {
+            server.documents_.status_bitmaps[static_cast<size_t>(statuses[ordinal])][ordinal] = false;
+            server.document_ordinals_.erase(ids[ordinal]);
+            server.live_ordinals_.Remove(static_cast<int>(ordinal));
+        }
+    }
+    server.UpdateDocumentCount(static_cast<int>(server.document_ordinals_.size()));
+
+    if (reader.Read<std::uint64_t>() != term_count) {
+        throw std::runtime_error("Snapshot " + path + " is inconsistent");
+    }
+    server.postings_.reserve(term_count);
+    size_t posting_entry_count = 0;
+    for (std::uint64_t term_id = 0; term_id < term_count; ++term_id) {
+        const int size = reader.Read<std::int32_t>();
+        const int last_document_id = reader.Read<std::int32_t>();
+        const std::uint64_t skip_count = reader.Read<std::uint64_t>();
+        const std::uint64_t byte_count = reader.Read<std::uint64_t>();
+        const std::span<const PostingList::SkipEntry> skips = reader.ReadArray<PostingList::SkipEntry>(skip_count);
+        const std::span<const std::uint8_t> bytes = reader.ReadArray<std::uint8_t>(byte_count);
+        if (!PostingList::IsValid(bytes, skips, size, last_document_id, static_cast<int>(ordinal_count))) {
+            throw std::runtime_error("Snapshot " + path + " contains an invalid posting list");
+        }
+        const PostingList& postings = server.postings_.emplace_back(bytes, skips, size, last_document_id);
+        // Каждая запись списка ведет в живой документ, в прямом индексе которого есть это слово с тем же
+        // числом вхождений; вместе с равенством общего числа записей это делает индексы взаимно обратными
+        for (const PostingList::Entry& entry : postings) {
+            const std::vector<DocumentTerm>& document_terms = server.documents_.terms[entry.document_id];
+            const auto term_it = std::lower_bound(document_terms.begin(), document_terms.end(), static_cast<int>(term_id),
+                [](const DocumentTerm& document_term, int id) { return document_term.term_id < id; });
+            if (!is_alive[entry.document_id] || term_it == document_terms.end() || term_it->term_id != static_cast<int>(term_id)
+                || term_it->term_count != entry.term_count) {
+                throw std::runtime_error("Snapshot " + path + " is inconsistent");
+            }
+        }
+        posting_entry_count += postings.size();
+        server.UpdateDocumentFrequency(static_cast<int>(term_id));
+    }
+    if (posting_entry_count != live_term_count) {
+        throw std::runtime_error("Snapshot " + path + " is inconsistent");
+    }
+
+    return server;
+}
\ No newline at end of file
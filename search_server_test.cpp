@@ -1,7 +1,34 @@
 #include "search_server_test.h"
+#include "allocation_counter.h"
+#include "benchmark_suite.h"
+#include "concurrent_search_server.h"
+#include "corpus_generator.h"
+#include "document_loader.h"
+#include "live_ordinals.h"
+#include "paginator.h"
+#include "process_queries.h"
+#include "query_arena.h"
+#include "posting_list.h"
+#include "remove_duplicates.h"
+#include "request_queue.h"
+#include "score_accumulator.h"
+#include "sharded_search_server.h"
 
+#include <chrono>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory_resource>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include <unistd.h>
+
 using namespace std;
 
 
@@ -125,27 +152,27 @@ void TestDocumentsMatchingSearchRequest() {
     {
         SearchServer server(""s);
         server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-        tuple<vector<string>, DocumentStatus> result;
+        tuple<vector<string_view>, DocumentStatus> result;
         result = server.MatchDocument("cat in the city"s, 1);
-        ASSERT(result == tuple(vector<string> {"cat"s, "city"s, "in"s, "the"s}, DocumentStatus::ACTUAL));
+        ASSERT(result == tuple(vector<string_view> {"cat"sv, "city"sv, "in"sv, "the"sv}, DocumentStatus::ACTUAL));
         result = server.MatchDocument("cat the city"s, 1);
-        ASSERT(result == tuple(vector<string> {"cat"s, "city"s, "the"s}, DocumentStatus::ACTUAL));
+        ASSERT(result == tuple(vector<string_view> {"cat"sv, "city"sv, "the"sv}, DocumentStatus::ACTUAL));
         result = server.MatchDocument("cat -in the city"s, 1);
-        ASSERT(result == tuple(vector<string> {}, DocumentStatus::ACTUAL));
+        ASSERT(result == tuple(vector<string_view> {}, DocumentStatus::ACTUAL));
     }
 
     {
         SearchServer server("in the"s);
         server.AddDocument(doc_id, content, DocumentStatus::BANNED, ratings);
-        tuple<vector<string>, DocumentStatus> result;
+        tuple<vector<string_view>, DocumentStatus> result;
         result = server.MatchDocument("cat in the city"s, 1);
-        ASSERT(result == tuple(vector<string> {"cat"s, "city"s}, DocumentStatus::BANNED));
+        ASSERT(result == tuple(vector<string_view> {"cat"sv, "city"sv}, DocumentStatus::BANNED));
         result = server.MatchDocument("cat the"s, 1);
-        ASSERT(result == tuple(vector<string> {"cat"s}, DocumentStatus::BANNED));
+        ASSERT(result == tuple(vector<string_view> {"cat"sv}, DocumentStatus::BANNED));
         result = server.MatchDocument("cat -in the city"s, 1);
-        ASSERT(result == tuple(vector<string> {"cat"s, "city"s}, DocumentStatus::BANNED));
+        ASSERT(result == tuple(vector<string_view> {"cat"sv, "city"sv}, DocumentStatus::BANNED));
         result = server.MatchDocument("cat -in the -city"s, 1);
-        ASSERT(result == tuple(vector<string> {}, DocumentStatus::BANNED));
+        ASSERT(result == tuple(vector<string_view> {}, DocumentStatus::BANNED));
     }
 }
 
@@ -395,6 +422,1300 @@ void TestComputationOfDocumentRelevance() {
 }
 
 
+void TestFindTopDocumentsResultCount() {
+    SearchServer server(""s);
+    for (int document_id = 1; document_id <= 20; ++document_id) {
+        string content = "cat"s;
+        for (int i = 0; i < document_id % 7; ++i) {
+            content += " dog"s;
+        }
+        server.AddDocument(document_id, content, DocumentStatus::ACTUAL, {document_id % 4});
+    }
+    server.AddDocument(21, "bird"s, DocumentStatus::ACTUAL, {1});
+
+    ASSERT_EQUAL(server.FindTopDocuments("cat dog"s).size(), static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT));
+    ASSERT(server.FindTopDocuments("cat dog"s, 0).empty());
+    const vector<Document> all_documents = server.FindTopDocuments("cat dog"s, 100);
+    ASSERT_EQUAL(all_documents.size(), 20u);
+    for (size_t i = 1; i < all_documents.size(); ++i) {
+        const Document& lhs = all_documents[i - 1];
+        const Document& rhs = all_documents[i];
+        ASSERT_HINT(lhs.relevance > rhs.relevance - EPSILON, "Documents must be sorted by relevance"s);
+        if (abs(lhs.relevance - rhs.relevance) < EPSILON) {
+            ASSERT_HINT(lhs.rating > rhs.rating || (lhs.rating == rhs.rating && lhs.id < rhs.id),
+                        "Documents with equal relevance must be sorted by rating, then by id"s);
+        }
+    }
+    for (const size_t result_count : {1u, 3u, 7u, 19u, 20u}) {
+        for (const vector<Document>& top_documents : {server.FindTopDocuments("cat dog"s, result_count),
+                                                      server.FindTopDocuments("cat dog"s, DocumentStatus::ACTUAL, result_count),
+                                                      server.FindTopDocuments(execution::par, "cat dog"s, result_count)}) {
+            ASSERT_EQUAL(top_documents.size(), result_count);
+            for (size_t i = 0; i < result_count; ++i) {
+                ASSERT_EQUAL(top_documents[i].id, all_documents[i].id);
+            }
+        }
+    }
+}
+
+
+void TestGetWordFrequencies() {
+    SearchServer server("and"s);
+    server.AddDocument(1, "curly cat and curly tail"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "and"s, DocumentStatus::ACTUAL, {1});
+
+    const map<string_view, double> word_freqs = server.GetWordFrequencies(1);
+    ASSERT_EQUAL(word_freqs.size(), 3u);
+    ASSERT(abs(word_freqs.at("curly"sv) - 2.0 / 4) < EPSILON);
+    ASSERT(abs(word_freqs.at("cat"sv) - 1.0 / 4) < EPSILON);
+    ASSERT(abs(word_freqs.at("tail"sv) - 1.0 / 4) < EPSILON);
+    ASSERT_HINT(server.GetWordFrequencies(2).empty(), "Document of stop words has no word frequencies"s);
+    ASSERT_HINT(server.GetWordFrequencies(100).empty(), "Unknown document has no word frequencies"s);
+}
+
+
+void TestFilterAfterReaddingDocument() {
+    SearchServer server("and"s);
+    server.AddDocument(1, "curly cat"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "curly dog"s, DocumentStatus::BANNED, {2});
+    server.AddDocument(3, "curly bird"s, DocumentStatus::ACTUAL, {3});
+    server.RemoveDocument(1);
+    server.AddDocument(1, "curly cat and fancy collar"s, DocumentStatus::BANNED, {5});
+
+    const auto to_ids = [](const vector<Document>& documents) {
+        vector<int> ids;
+        for (const Document& document : documents) {
+            ids.push_back(document.id);
+        }
+        sort(ids.begin(), ids.end());
+        return ids;
+    };
+    ASSERT(to_ids(server.FindTopDocuments("curly"s)) == vector<int>({3}));
+    ASSERT(to_ids(server.FindTopDocuments("curly"s, DocumentStatus::BANNED)) == vector<int>({1, 2}));
+    ASSERT(to_ids(server.FindTopDocuments(execution::par, "curly"s, DocumentStatus::BANNED)) == vector<int>({1, 2}));
+    ASSERT(server.FindTopDocuments("curly"s, DocumentStatus::IRRELEVANT).empty());
+    ASSERT(to_ids(server.FindTopDocuments("curly"s, [](int document_id, DocumentStatus status, int rating) { return rating >= 3; }))
+           == vector<int>({1, 3}));
+    ASSERT_EQUAL(server.FindTopDocuments("cat"s, DocumentStatus::BANNED)[0].rating, 5);
+    ASSERT(get<1>(server.MatchDocument("cat"s, 1)) == DocumentStatus::BANNED);
+    ASSERT_EQUAL(server.GetDocumentId(2), 1);
+}
+
+
+void TestTermStatistics() {
+    SearchServer server("and"s);
+    server.AddDocument(1, "curly cat and curly tail"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "fluffy cat"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocuments({ {3, "cat"s, DocumentStatus::BANNED, {1}}, {4, "dog"s, DocumentStatus::ACTUAL, {1}} });
+
+    const auto check_statistics = [](const SearchServer& search_server, string_view word, int document_frequency, double max_term_frequency) {
+        const optional<TermStatistics> statistics = search_server.GetTermStatistics(word);
+        ASSERT(statistics.has_value());
+        ASSERT_EQUAL(statistics->document_frequency, document_frequency);
+        ASSERT(abs(statistics->inverse_document_frequency - log(static_cast<double>(search_server.GetDocumentCount()) / document_frequency)) < EPSILON);
+        ASSERT(abs(statistics->max_term_frequency - max_term_frequency) < EPSILON);
+    };
+    check_statistics(server, "cat"sv, 3, 1.0);
+    check_statistics(server, "curly"sv, 1, 2.0 / 4);
+    check_statistics(server, "dog"sv, 1, 1.0);
+    ASSERT_HINT(!server.GetTermStatistics("and"sv).has_value(), "Stop word has no statistics"s);
+    ASSERT_HINT(!server.GetTermStatistics("bird"sv).has_value(), "Unknown word has no statistics"s);
+
+    server.RemoveDocument(3);
+    server.RemoveDocument(4);
+    check_statistics(server, "cat"sv, 2, 1.0);
+    check_statistics(server, "tail"sv, 1, 1.0 / 4);
+    ASSERT_HINT(!server.GetTermStatistics("dog"sv).has_value(), "Word without documents has no statistics"s);
+    const vector<Document> found_docs = server.FindTopDocuments("curly"s);
+    ASSERT_EQUAL(found_docs.size(), 1u);
+    ASSERT(abs(found_docs[0].relevance - 2.0 / 4 * log(2.0)) < EPSILON);
+
+    const string path = (filesystem::temp_directory_path() / ("search_server_term_statistics_"s + to_string(getpid()) + ".bin"s)).string();
+    server.SaveSnapshot(path);
+    const SearchServer loaded = SearchServer::LoadSnapshot(path);
+    filesystem::remove(path);
+    // Загрузка пересчитывает max TF по оставшимся документам
+    check_statistics(loaded, "cat"sv, 2, 1.0 / 2);
+    check_statistics(loaded, "curly"sv, 1, 2.0 / 4);
+    ASSERT(!loaded.GetTermStatistics("dog"sv).has_value());
+}
+
+
+void TestRemoveDocument() {
+    const auto make_server = [] {
+        SearchServer server("and with"s);
+        server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
+        server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+        server.AddDocument(3, "big cat nasty hair"s, DocumentStatus::ACTUAL, {1, 2, 8});
+        server.AddDocument(4, "with"s, DocumentStatus::BANNED, {1});
+        return server;
+    };
+
+    for (const bool parallel : {false, true}) {
+        SearchServer server = make_server();
+        const auto remove_document = [&server, parallel](int document_id) {
+            if (parallel) {
+                server.RemoveDocument(execution::par, document_id);
+            } else {
+                server.RemoveDocument(document_id);
+            }
+        };
+
+        remove_document(2);
+        ASSERT_EQUAL(server.GetDocumentCount(), 3);
+        ASSERT_EQUAL(server.GetDocumentId(1), 3);
+        ASSERT_HINT(server.FindTopDocuments("curly"s).empty(), "Words of removed document must not be found"s);
+        const vector<Document> found_docs = server.FindTopDocuments("funny hair"s);
+        ASSERT_EQUAL(found_docs.size(), 2u);
+        for (const Document& document : found_docs) {
+            ASSERT(document.id != 2);
+        }
+        ASSERT(abs(found_docs[0].relevance - 1.0 / 4 * log(3.0 / 1)) < EPSILON);
+        ASSERT(server.GetWordFrequencies(2).empty());
+
+        remove_document(100);
+        ASSERT_EQUAL_HINT(server.GetDocumentCount(), 3, "Removal of unknown document must be ignored"s);
+
+        remove_document(4);
+        remove_document(1);
+        remove_document(3);
+        ASSERT_EQUAL(server.GetDocumentCount(), 0);
+        ASSERT(server.FindTopDocuments("funny pet nasty rat big cat"s).empty());
+
+        server.AddDocument(2, "curly dog"s, DocumentStatus::ACTUAL, {3});
+        ASSERT_EQUAL_HINT(server.FindTopDocuments("curly"s).size(), 1u, "Removed ID may be added again"s);
+    }
+}
+
+
+void TestCompact() {
+    SearchServer server("and"s);
+    for (int id = 0; id < 400; ++id) {
+        const DocumentStatus status = id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        server.AddDocument(id, "cat"s + to_string(id % 5) + " and dog"s + to_string(id % 3) + " unique"s + to_string(id), status, {id % 9});
+    }
+    for (int id = 0; id < 400; ++id) {
+        if (id % 10 != 0) {
+            server.RemoveDocument(id);
+        }
+    }
+    server.RemoveDocument(20);
+    server.AddDocument(20, "cat1 dog2 readded"s, DocumentStatus::ACTUAL, {5});
+    server.SetResultCacheCapacity(8);
+
+    vector<int> document_ids;
+    for (int index = 0; index < server.GetDocumentCount(); ++index) {
+        document_ids.push_back(server.GetDocumentId(index));
+    }
+    const vector<string> queries = {"cat0 dog1"s, "cat1 -dog2"s, "unique30 cat0"s, "readded"s};
+    vector<vector<Document>> expected;
+    for (const string& query : queries) {
+        expected.push_back(server.FindTopDocuments(query, 100));
+        expected.push_back(server.FindTopDocuments(query, DocumentStatus::BANNED, 100));
+    }
+    const IndexMemoryUsage memory_before = server.GetMemoryUsage();
+
+    server.Compact();
+    ASSERT_HINT(server.GetMemoryUsage().GetTotal() < memory_before.GetTotal() / 2, "Removed ordinals and words must be released"s);
+    ASSERT(!server.GetTermStatistics("unique31"sv).has_value());
+    for (int index = 0; index < server.GetDocumentCount(); ++index) {
+        ASSERT_EQUAL(server.GetDocumentId(index), document_ids[index]);
+    }
+    for (size_t i = 0; i < queries.size(); ++i) {
+        for (const auto& [found, expected_documents] : {pair{server.FindTopDocuments(queries[i], 100), expected[2 * i]},
+                                                        pair{server.FindTopDocuments(queries[i], DocumentStatus::BANNED, 100), expected[2 * i + 1]}}) {
+            ASSERT_EQUAL(found.size(), expected_documents.size());
+            for (size_t j = 0; j < found.size(); ++j) {
+                ASSERT_EQUAL(found[j].id, expected_documents[j].id);
+                ASSERT_EQUAL(found[j].relevance, expected_documents[j].relevance);
+                ASSERT_EQUAL(found[j].rating, expected_documents[j].rating);
+            }
+        }
+    }
+    const map<string_view, double> expected_frequencies = {{"cat1"sv, 1.0 / 3}, {"dog2"sv, 1.0 / 3}, {"readded"sv, 1.0 / 3}};
+    ASSERT(server.GetWordFrequencies(20) == expected_frequencies);
+
+    server.RemoveDocument(30);
+    server.AddDocument(1000, "cat0 fresh"s, DocumentStatus::ACTUAL, {1});
+    ASSERT_EQUAL(server.FindTopDocuments("fresh"s)[0].id, 1000);
+    ASSERT(server.FindTopDocuments("unique30"s).empty());
+}
+
+
+void TestRemoveDuplicates() {
+    SearchServer server("and with"s);
+    server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(3, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(4, "funny pet and curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(5, "funny funny pet and nasty nasty rat"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(6, "funny pet and not very nasty rat"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(7, "very nasty rat and not very funny pet"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(8, "pet with rat and rat and rat"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(9, "nasty rat with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(10, "and"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(11, "with"s, DocumentStatus::ACTUAL, {1});
+
+    const vector<int> duplicate_ids = RemoveDuplicates(server);
+    ASSERT(duplicate_ids == vector<int>({3, 4, 5, 7, 11}));
+    ASSERT_EQUAL(server.GetDocumentCount(), 6);
+    for (const int document_id : duplicate_ids) {
+        ASSERT_HINT(server.GetWordFrequencies(document_id).empty(), "Duplicates must be removed from the server"s);
+    }
+    ASSERT_HINT(RemoveDuplicates(server).empty(), "Server without duplicates must stay unchanged"s);
+}
+
+
+void TestQueryAllocationsDoNotDependOnWordCount() {
+    SearchServer server("and with"s);
+    server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1, 2});
+
+    const auto count_allocations = [&server](string_view query) {
+        const size_t allocations_before = GetAllocationCount();
+        server.FindTopDocuments(query);
+        return GetAllocationCount() - allocations_before;
+    };
+    const string short_query = "curly -nasty"s;
+    string long_query = short_query;
+    for (int i = 0; i < 100; ++i) {
+        long_query += " unknown"s + to_string(i) + " -absent"s + to_string(i) + " with"s;
+    }
+    if constexpr (ALLOCATION_COUNTING_ENABLED) {
+        ASSERT_EQUAL_HINT(count_allocations(long_query), count_allocations(short_query),
+                          "Query parsing and index lookups must not allocate per word"s);
+    }
+
+    const SearchServer server_from_literal("and with");
+    ASSERT_EQUAL(server_from_literal.GetDocumentCount(), 0);
+}
+
+
+void TestQueryArena() {
+    {
+        const QueryArena::Scope outer_scope;
+        const pmr::vector<int> outer_values({1, 2, 3}, outer_scope.GetResource());
+        {
+            const QueryArena::Scope inner_scope;
+            const pmr::vector<int> inner_values(1'000, 7, inner_scope.GetResource());
+        }
+        const pmr::vector<int> more_values(100, 5, outer_scope.GetResource());
+        ASSERT_HINT(outer_values == pmr::vector<int>({1, 2, 3}), "Inner scope must not release the outer scope memory"s);
+    }
+    {
+        const QueryArena::Scope scope;
+        const pmr::vector<char> large_values(QueryArena::BUFFER_SIZE * 4, 'x', scope.GetResource());
+        ASSERT_EQUAL(large_values.back(), 'x');
+    }
+
+    SearchServer server("and with"s);
+    for (int id = 0; id < 20; ++id) {
+        server.AddDocument(id, id % 2 == 0 ? "funny pet and nasty rat"s : "funny dog with curly hair"s, DocumentStatus::ACTUAL, {id});
+    }
+    for (const string& query : {"funny curly -nasty"s, "pet rat dog"s}) {
+        for (const size_t result_count : {size_t{5}, size_t{100}}) {
+            server.FindTopDocuments(query, result_count);
+            const size_t allocations_before = GetAllocationCount();
+            const vector<Document> documents = server.FindTopDocuments(query, result_count);
+            const size_t allocation_count = GetAllocationCount() - allocations_before;
+            if constexpr (ALLOCATION_COUNTING_ENABLED) {
+                ASSERT_EQUAL_HINT(allocation_count, 1u, "Only the result may be allocated on the heap"s);
+            }
+            ASSERT(!documents.empty());
+        }
+    }
+}
+
+
+void TestPostingList() {
+    PostingList postings;
+    vector<PostingList::Entry> expected;
+    for (int document_id = 0; document_id < 1000; document_id += 3) {
+        const int term_count = document_id % 5 + 1;
+        postings.Add(document_id * 1000, term_count);
+        expected.push_back({ document_id * 1000, term_count });
+    }
+    postings.Add(1, 7);
+    expected.insert(expected.begin() + 1, { 1, 7 });
+    ASSERT_EQUAL(postings.size(), expected.size());
+
+    const auto check_entries = [&postings, &expected] {
+        size_t index = 0;
+        for (const PostingList::Entry& entry : postings) {
+            ASSERT_EQUAL(entry.document_id, expected[index].document_id);
+            ASSERT_EQUAL(entry.term_count, expected[index].term_count);
+            ++index;
+        }
+        ASSERT_EQUAL(index, expected.size());
+    };
+    check_entries();
+
+    ASSERT(postings.Remove(1));
+    expected.erase(expected.begin() + 1);
+    ASSERT(!postings.Remove(2));
+    ASSERT(!postings.Remove(1));
+    check_entries();
+
+    // Удаленные записи пропускаются, в том числе первые записи блоков и многобайтные числа вхождений
+    postings.Add(1'000'000, 300);
+    expected.push_back({ 1'000'000, 300 });
+    for (const int document_id : {0, 64 * 3000, 65 * 3000, 1'000'000}) {
+        ASSERT(postings.Remove(document_id));
+        expected.erase(find_if(expected.begin(), expected.end(),
+                               [document_id](const PostingList::Entry& entry) { return entry.document_id == document_id; }));
+    }
+    ASSERT(postings.HasRemovedEntries());
+    ASSERT_EQUAL(postings.size(), expected.size());
+    check_entries();
+
+    for (const int target : {0, 1, 500'000, 500'001, 998'999, 999'000}) {
+        auto it = postings.begin();
+        it.SkipTo(target);
+        const auto expected_it = find_if(expected.begin(), expected.end(),
+                                         [target](const PostingList::Entry& entry) { return entry.document_id >= target; });
+        if (expected_it == expected.end()) {
+            ASSERT(it == postings.end());
+        } else {
+            ASSERT_EQUAL_HINT(it->document_id, expected_it->document_id, "SkipTo must stop at the first document not less than target"s);
+        }
+    }
+    ASSERT_HINT(postings.GetMemoryUsage() < expected.size() * sizeof(PostingList::Entry),
+                "Compressed postings must be smaller than plain pairs"s);
+
+    // Когда удалено больше четверти записей, список уплотняется
+    const size_t encoded_size = postings.size() + 4;
+    while (postings.HasRemovedEntries()) {
+        ASSERT(postings.Remove(expected.back().document_id));
+        expected.pop_back();
+    }
+    ASSERT_HINT(expected.size() * 4 >= encoded_size * 3 - 4, "List must be compacted once a quarter of entries is removed"s);
+    check_entries();
+}
+
+
+void TestLiveOrdinals() {
+    LiveOrdinals live_ordinals;
+    vector<int> expected;
+    mt19937 generator(5);
+    for (int ordinal = 0; ordinal < 300; ++ordinal) {
+        live_ordinals.Append();
+        expected.push_back(ordinal);
+        if (ordinal % 3 == 2) {
+            const size_t index = uniform_int_distribution<size_t>(0, expected.size() - 1)(generator);
+            live_ordinals.Remove(expected[index]);
+            expected.erase(expected.begin() + static_cast<ptrdiff_t>(index));
+        }
+    }
+    ASSERT_EQUAL(live_ordinals.GetLiveCount(), static_cast<int>(expected.size()));
+    for (size_t index = 0; index < expected.size(); ++index) {
+        ASSERT_EQUAL(live_ordinals.FindOrdinal(static_cast<int>(index)), expected[index]);
+    }
+}
+
+
+void TestScoreAccumulator() {
+    {
+        const ScoreAccumulator::Lease accumulator = ScoreAccumulator::Acquire(10);
+        accumulator->Exclude(3);
+        accumulator->Add(7, 0.5);
+        accumulator->Add(2, 0.0);
+        accumulator->Add(7, 0.25);
+        ASSERT(accumulator->GetTouched() == vector<int>({7, 2}));
+        ASSERT_EQUAL(accumulator->GetScore(7), 0.75);
+        ASSERT(accumulator->IsExcluded(3));
+        ASSERT(!accumulator->IsExcluded(7));
+
+        const ScoreAccumulator::Lease nested_accumulator = ScoreAccumulator::Acquire(10);
+        ASSERT_HINT(&*nested_accumulator != &*accumulator, "Nested lease must get its own accumulator"s);
+        ASSERT(nested_accumulator->GetTouched().empty());
+    }
+    const ScoreAccumulator::Lease accumulator = ScoreAccumulator::Acquire(20);
+    ASSERT_HINT(accumulator->GetTouched().empty(), "Acquired accumulator must be reset"s);
+    ASSERT_EQUAL(accumulator->GetScore(7), 0.0);
+    ASSERT(!accumulator->IsExcluded(3));
+    accumulator->Add(19, 1.0);
+    ASSERT_EQUAL(accumulator->GetScore(19), 1.0);
+
+    SearchServer server("and"s);
+    server.AddDocument(1, "curly cat"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "curly dog"s, DocumentStatus::ACTUAL, {2});
+    server.AddDocument(3, "fluffy dog"s, DocumentStatus::ACTUAL, {3});
+    const auto is_found_by_dog = [&server](int document_id, DocumentStatus status, int rating) {
+        for (const Document& document : server.FindTopDocuments("dog -cat"s, 10)) {
+            if (document.id == document_id) {
+                return true;
+            }
+        }
+        return false;
+    };
+    const vector<Document> found_docs = server.FindTopDocuments("curly fluffy -cat"s, is_found_by_dog, 10);
+    ASSERT_EQUAL_HINT(found_docs.size(), 2u, "Search from a predicate must not disturb the outer search"s);
+}
+
+
+void TestGetMemoryUsage() {
+    SearchServer server("and"s);
+    const IndexMemoryUsage empty_usage = server.GetMemoryUsage();
+    server.AddDocument(1, "curly cat and curly tail"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "fluffy cat"s, DocumentStatus::ACTUAL, {1});
+    const IndexMemoryUsage usage = server.GetMemoryUsage();
+    ASSERT(usage.postings > empty_usage.postings);
+    ASSERT(usage.terms > empty_usage.terms);
+    ASSERT(usage.documents > empty_usage.documents);
+    ASSERT_EQUAL(usage.GetTotal(), usage.postings + usage.terms + usage.documents);
+}
+
+
+void TestSnapshotRoundTrip() {
+    SearchServer server("and with"s);
+    int document_id = 0;
+    for (int i = 0; i < 300; ++i) {
+        const string content = "pet"s + to_string(i % 7) + " rat"s + to_string(i % 11) + " and funny cat"s + (i % 3 == 0 ? " curly hair"s : ""s);
+        document_id += 1 + i % 4;
+        server.AddDocument(document_id, content, i % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, {i % 10, 3});
+    }
+    server.AddDocument(100'000, "and with"s, DocumentStatus::ACTUAL, {});
+    server.RemoveDocument(5);
+    server.RemoveDocument(3);
+    server.AddDocument(3, "funny cat with curly hair"s, DocumentStatus::IRRELEVANT, {4});
+
+    const string path = (filesystem::temp_directory_path() / ("search_server_snapshot_test_"s + to_string(getpid()) + ".bin"s)).string();
+    server.SaveSnapshot(path);
+    {
+        SearchServer loaded = SearchServer::LoadSnapshot(path);
+        ASSERT_EQUAL(loaded.GetDocumentCount(), server.GetDocumentCount());
+        for (int index = 0; index < server.GetDocumentCount(); ++index) {
+            ASSERT_EQUAL(loaded.GetDocumentId(index), server.GetDocumentId(index));
+        }
+        for (const string& query : {"funny cat"s, "pet3 rat5 -curly"s, "hair pet1 and"s, "unknown"s, "rat10 cat"s}) {
+            for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED, DocumentStatus::IRRELEVANT}) {
+                const vector<Document> expected = server.FindTopDocuments(query, status, 50);
+                const vector<Document> result = loaded.FindTopDocuments(query, status, 50);
+                ASSERT_EQUAL_HINT(result.size(), expected.size(), "Loaded snapshot must find the same documents"s);
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    ASSERT_EQUAL(result[i].id, expected[i].id);
+                    ASSERT_EQUAL(result[i].relevance, expected[i].relevance);
+                    ASSERT_EQUAL(result[i].rating, expected[i].rating);
+                }
+            }
+            ASSERT(loaded.MatchDocument(query, 3) == server.MatchDocument(query, 3));
+        }
+        ASSERT(loaded.GetWordFrequencies(3) == server.GetWordFrequencies(3));
+
+        loaded.AddDocument(100'001, "funny cat and curly hair"s, DocumentStatus::ACTUAL, {100});
+        loaded.RemoveDocument(1);
+        ASSERT_EQUAL(loaded.GetWordFrequencies(100'001).size(), 4u);
+        ASSERT_HINT(loaded.GetWordFrequencies(100'001).count("and"sv) == 0, "Stop words must survive the snapshot"s);
+        ASSERT_EQUAL(loaded.FindTopDocuments("curly"s, 1)[0].id, 100'001);
+        ASSERT(loaded.GetWordFrequencies(1).empty());
+    }
+
+    // Порча любого байта снимка либо отвергается при загрузке, либо дает индекс, с которым можно работать
+    SearchServer small_server("and"s);
+    for (int id = 0; id < 70; ++id) {
+        small_server.AddDocument(id, "cat"s + to_string(id % 3) + " and dog"s + (id % 2 == 0 ? " curly"s : ""s), DocumentStatus::ACTUAL, {id});
+    }
+    small_server.RemoveDocument(4);
+    small_server.SaveSnapshot(path);
+    string snapshot_bytes;
+    {
+        ifstream input(path, ios::binary);
+        snapshot_bytes.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+    for (size_t position = 16; position < snapshot_bytes.size(); ++position) {
+        for (const char value : {'\x00', '\x01', '\x7F', '\x80', '\xFF'}) {
+            string corrupted_bytes = snapshot_bytes;
+            corrupted_bytes[position] = value;
+            {
+                ofstream corrupted(path, ios::binary | ios::trunc);
+                corrupted << corrupted_bytes;
+            }
+            try {
+                const SearchServer loaded = SearchServer::LoadSnapshot(path);
+                for (const string& query : {"cat1 dog"s, "curly -cat2"s}) {
+                    loaded.FindTopDocuments(query, 100);
+                    loaded.FindTopDocuments(query, [](int, DocumentStatus, int) { return true; }, 100);
+                }
+                for (int index = 0; index < loaded.GetDocumentCount(); ++index) {
+                    loaded.MatchDocument("cat0 curly"s, loaded.GetDocumentId(index));
+                    loaded.GetWordFrequencies(loaded.GetDocumentId(index));
+                }
+            } catch (const runtime_error&) {
+            }
+        }
+    }
+
+    {
+        ofstream corrupted(path, ios::binary | ios::trunc);
+        corrupted << "not a snapshot"s;
+    }
+    bool is_rejected = false;
+    try {
+        SearchServer::LoadSnapshot(path);
+    } catch (const runtime_error&) {
+        is_rejected = true;
+    }
+    ASSERT_HINT(is_rejected, "Corrupted snapshot must be rejected"s);
+    filesystem::remove(path);
+}
+
+
+void TestAddDocuments() {
+    vector<string> contents;
+    for (int i = 0; i < 200; ++i) {
+        contents.push_back("pet"s + to_string(i % 13) + " rat"s + to_string(i % 7) + " and funny cat"s + (i % 4 == 0 ? " cat"s : ""s));
+    }
+    const auto make_raw_documents = [&contents](int first, int last) {
+        vector<RawDocument> documents;
+        for (int i = first; i < last; ++i) {
+            // ID идут не по порядку, чтобы пакет вставлялся в середину списков документов
+            documents.push_back({ (i * 37) % 200, contents[i], i % 3 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, {i, 1} });
+        }
+        return documents;
+    };
+
+    SearchServer expected_server("and"s);
+    for (const RawDocument& document : make_raw_documents(0, 200)) {
+        expected_server.AddDocument(document.id, document.content, document.status, document.ratings);
+    }
+
+    for (const bool parallel : {false, true}) {
+        SearchServer server("and"s);
+        for (const auto& [first, last] : {pair{0, 50}, pair{50, 200}}) {
+            if (parallel) {
+                server.AddDocuments(execution::par, make_raw_documents(first, last));
+            } else {
+                server.AddDocuments(make_raw_documents(first, last));
+            }
+        }
+        ASSERT_EQUAL(server.GetDocumentCount(), expected_server.GetDocumentCount());
+        for (int index = 0; index < server.GetDocumentCount(); ++index) {
+            ASSERT_EQUAL(server.GetDocumentId(index), expected_server.GetDocumentId(index));
+        }
+        for (const string& query : {"funny cat"s, "pet3 rat5 -rat2"s, "cat pet12"s}) {
+            const vector<Document> expected = expected_server.FindTopDocuments(query, 30);
+            const vector<Document> result = server.FindTopDocuments(query, 30);
+            ASSERT_EQUAL_HINT(result.size(), expected.size(), "Bulk ingestion must index the same documents"s);
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_EQUAL(result[i].id, expected[i].id);
+                ASSERT(abs(result[i].relevance - expected[i].relevance) < EPSILON);
+                ASSERT_EQUAL(result[i].rating, expected[i].rating);
+            }
+        }
+        ASSERT(server.GetWordFrequencies(0) == expected_server.GetWordFrequencies(0));
+
+        const auto expect_rejected = [&server](const vector<RawDocument>& documents) {
+            const int document_count = server.GetDocumentCount();
+            bool is_rejected = false;
+            try {
+                server.AddDocuments(execution::par, documents);
+            } catch (const invalid_argument&) {
+                is_rejected = true;
+            }
+            ASSERT_HINT(is_rejected, "Invalid batch must be rejected"s);
+            ASSERT_EQUAL_HINT(server.GetDocumentCount(), document_count, "Rejected batch must not change the index"s);
+        };
+        expect_rejected({ { 300, "good document"sv, DocumentStatus::ACTUAL, {} }, { -1, "negative id"sv, DocumentStatus::ACTUAL, {} } });
+        expect_rejected({ { 300, "good document"sv, DocumentStatus::ACTUAL, {} }, { 5, "existing id"sv, DocumentStatus::ACTUAL, {} } });
+        expect_rejected({ { 300, "good document"sv, DocumentStatus::ACTUAL, {} }, { 300, "same id twice"sv, DocumentStatus::ACTUAL, {} } });
+        expect_rejected({ { 300, "good document"sv, DocumentStatus::ACTUAL, {} }, { 301, "bad \x12 word"sv, DocumentStatus::ACTUAL, {} } });
+        ASSERT(server.FindTopDocuments("good"s).empty());
+    }
+}
+
+
+void TestPrunedTopDocumentsMatchExhaustiveSearch() {
+    mt19937 generator(7);
+    const auto random_int = [&generator](int min_value, int max_value) {
+        return uniform_int_distribution<int>(min_value, max_value)(generator);
+    };
+    vector<string> dictionary;
+    for (int i = 0; i < 40; ++i) {
+        dictionary.push_back("w"s + to_string(i));
+    }
+    // Слова с меньшими номерами встречаются чаще, чтобы границы вкладов различались
+    const auto random_word = [&]() {
+        return dictionary[min(random_int(0, 39), random_int(0, 39))];
+    };
+
+    SearchServer server("w0"s);
+    const int document_count = 400;
+    for (int document_id = 0; document_id < document_count; ++document_id) {
+        string content;
+        const int word_count = random_int(1, 15);
+        for (int i = 0; i < word_count; ++i) {
+            content += random_word() + ' ';
+        }
+        server.AddDocument(document_id, content, static_cast<DocumentStatus>(random_int(0, 3)), {random_int(0, 3)});
+    }
+    for (int document_id = 0; document_id < document_count; document_id += 17) {
+        server.RemoveDocument(document_id);
+    }
+
+    const auto predicate = [](int document_id, DocumentStatus status, int rating) { return document_id % 3 != 0; };
+    for (int query_index = 0; query_index < 300; ++query_index) {
+        string query;
+        const int plus_word_count = random_int(1, 6);
+        for (int i = 0; i < plus_word_count; ++i) {
+            query += random_word() + ' ';
+        }
+        const int minus_word_count = random_int(0, 2);
+        for (int i = 0; i < minus_word_count; ++i) {
+            query += '-' + dictionary[random_int(0, 39)] + ' ';
+        }
+
+        const vector<Document> all_actual = server.FindTopDocuments(query, DocumentStatus::ACTUAL, document_count);
+        const vector<Document> all_filtered = server.FindTopDocuments(query, predicate, document_count);
+        for (const size_t result_count : {1u, 2u, 5u, 10u, 30u}) {
+            for (const auto& [top_documents, all_documents] : {pair{server.FindTopDocuments(query, DocumentStatus::ACTUAL, result_count), all_actual},
+                                                               pair{server.FindTopDocuments(query, predicate, result_count), all_filtered}}) {
+                ASSERT_EQUAL_HINT(top_documents.size(), min(result_count, all_documents.size()), query);
+                for (size_t i = 0; i < top_documents.size(); ++i) {
+                    ASSERT_EQUAL_HINT(top_documents[i].id, all_documents[i].id, query);
+                    ASSERT_HINT(top_documents[i].relevance == all_documents[i].relevance, "Relevance must match bit for bit: "s + query);
+                }
+            }
+        }
+    }
+}
+
+
+void TestResultCache() {
+    SearchServer server("and"s);
+    server.AddDocument(1, "white cat and fancy collar"s, DocumentStatus::ACTUAL, {5});
+    server.AddDocument(2, "fluffy cat fluffy tail"s, DocumentStatus::ACTUAL, {3});
+    server.AddDocument(3, "groomed dog expressive eyes"s, DocumentStatus::BANNED, {1});
+
+    const vector<Document> uncached = server.FindTopDocuments("fluffy cat -collar"s);
+    server.FindTopDocuments("fluffy cat"s);
+    ASSERT_EQUAL_HINT(server.GetResultCacheStats().misses, 0u, "Cache must be disabled by default"s);
+
+    server.SetResultCacheCapacity(2);
+    server.FindTopDocuments("fluffy cat -collar"s);
+    const vector<Document> cached = server.FindTopDocuments("cat and fluffy cat -collar"s);
+    ASSERT_EQUAL(server.GetResultCacheStats().hits, 1u);
+    ASSERT_EQUAL(server.GetResultCacheStats().misses, 1u);
+    ASSERT_EQUAL(cached.size(), uncached.size());
+    ASSERT_EQUAL(cached[0].id, uncached[0].id);
+
+    server.FindTopDocuments("fluffy cat -collar"s, DocumentStatus::BANNED);
+    server.FindTopDocuments("fluffy cat -collar"s, 1);
+    server.FindTopDocuments(execution::par, "fluffy cat -collar"s);
+    ASSERT_EQUAL_HINT(server.GetResultCacheStats().misses, 4u, "Status and result count are part of the key"s);
+    ASSERT_EQUAL_HINT(server.GetResultCacheStats().hits, 1u, "Least recently used entry must be evicted"s);
+
+    server.FindTopDocuments("cat"s, [](int document_id, DocumentStatus status, int rating) { return true; });
+    ASSERT_EQUAL_HINT(server.GetResultCacheStats().misses, 4u, "Predicate queries are not cached"s);
+
+    server.FindTopDocuments("dog"s, DocumentStatus::BANNED);
+    server.AddDocument(4, "groomed dog"s, DocumentStatus::BANNED, {2});
+    ASSERT_EQUAL_HINT(server.FindTopDocuments("dog"s, DocumentStatus::BANNED).size(), 2u, "AddDocument must invalidate the cache"s);
+    server.RemoveDocument(3);
+    ASSERT_EQUAL_HINT(server.FindTopDocuments("dog"s, DocumentStatus::BANNED).size(), 1u, "RemoveDocument must invalidate the cache"s);
+    ASSERT_EQUAL(server.GetResultCacheStats().misses, 7u);
+
+    const SearchServer server_copy = server;
+    server_copy.FindTopDocuments("dog"s, DocumentStatus::BANNED);
+    ASSERT_EQUAL_HINT(server_copy.GetResultCacheStats().misses, 1u, "Copy must keep capacity but not entries"s);
+}
+
+
+// Для проверки гонок тест нужно собирать с -fsanitize=thread
+void TestConcurrentSearchServerStress() {
+    // Малые пределы, чтобы запечатывание и слияние сегментов шли под нагрузкой читателей
+    ConcurrentSearchServer server(SearchServer("and"s), 16, 128);
+    const int batch_count = 50;
+    const int batch_size = 10;
+    atomic<bool> is_writing = true;
+
+    thread writer([&server, &is_writing] {
+        vector<string> contents;
+        for (int i = 0; i < batch_count * batch_size; ++i) {
+            contents.push_back("common word"s + to_string(i % 17) + " and tail"s + to_string(i % 5));
+        }
+        for (int batch = 0; batch < batch_count; ++batch) {
+            vector<RawDocument> documents;
+            for (int i = batch * batch_size; i < (batch + 1) * batch_size; ++i) {
+                documents.push_back({ i, contents[i], DocumentStatus::ACTUAL, {i % 10} });
+            }
+            server.AddDocuments(documents);
+            if (batch % 5 == 4) {
+                server.RemoveDocument(batch * batch_size);
+            }
+        }
+        is_writing = false;
+    });
+
+    vector<thread> readers;
+    atomic<int> inconsistent_results = 0;
+    for (int reader = 0; reader < 3; ++reader) {
+        readers.emplace_back([&server, &is_writing, &inconsistent_results] {
+            uint64_t last_generation = 0;
+            while (is_writing) {
+                const shared_ptr<const ConcurrentSearchServer::Snapshot> snapshot = server.GetSnapshot();
+                const size_t found_count = snapshot->FindTopDocuments("common -absent"s, static_cast<size_t>(batch_count * batch_size)).size();
+                if (found_count != static_cast<size_t>(snapshot->GetDocumentCount())) {
+                    ++inconsistent_results;
+                }
+                server.FindTopDocuments(execution::seq, "word3 tail2"s, DocumentStatus::ACTUAL);
+                const uint64_t generation = server.GetGeneration();
+                if (generation < last_generation) {
+                    ++inconsistent_results;
+                }
+                last_generation = generation;
+            }
+        });
+    }
+    writer.join();
+    for (thread& reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_EQUAL_HINT(inconsistent_results.load(), 0, "Readers must always see a complete generation"s);
+    ASSERT_EQUAL(server.GetDocumentCount(), batch_count * batch_size - batch_count / 5);
+    ASSERT(get<0>(server.MatchDocument("word1 tail2 common"s, 1)) == vector<string>({"common"s, "word1"s}));
+    ASSERT_EQUAL(server.GetGeneration(), static_cast<uint64_t>(batch_count + batch_count / 5));
+
+    bool is_rejected = false;
+    try {
+        server.AddDocument(1, "duplicate id"s, DocumentStatus::ACTUAL, {});
+    } catch (const invalid_argument&) {
+        is_rejected = true;
+    }
+    ASSERT(is_rejected);
+    ASSERT_EQUAL_HINT(server.GetGeneration(), static_cast<uint64_t>(batch_count + batch_count / 5),
+                      "Failed update must not publish a new generation"s);
+}
+
+
+void TestConcurrentSearchServerSegments() {
+    const vector<string> words = {"cat"s, "dog"s, "bird"s, "fish"s, "and"s, "mouse"s, "horse"s};
+    mt19937 generator(13);
+    const auto generate_text = [&](int word_count) {
+        string text;
+        for (int i = 0; i < word_count; ++i) {
+            text += words[uniform_int_distribution<size_t>(0, words.size() - 1)(generator)] + ' ';
+        }
+        return text;
+    };
+    vector<string> contents;
+    for (int i = 0; i < 300; ++i) {
+        contents.push_back(generate_text(1 + i % 6));
+    }
+
+    SearchServer server("and"s);
+    SearchServer initial_server("and"s);
+    for (int id = 0; id < 40; ++id) {
+        server.AddDocument(id, contents[id], DocumentStatus::ACTUAL, {id % 7});
+        initial_server.AddDocument(id, contents[id], DocumentStatus::ACTUAL, {id % 7});
+    }
+    initial_server.RemoveDocument(5);
+    server.RemoveDocument(5);
+
+    // Исходный индекс крупнее дельты и разрезается на сегменты
+    ConcurrentSearchServer concurrent_server(move(initial_server), 4, 32);
+    ASSERT_EQUAL(concurrent_server.GetSnapshot()->GetSegmentCount(), 3u);
+    for (int id = 40; id < 100; ++id) {
+        const DocumentStatus status = id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        server.AddDocument(id, contents[id], status, {id % 7});
+        concurrent_server.AddDocument(id, contents[id], status, {id % 7});
+    }
+    vector<RawDocument> batch;
+    for (int id = 100; id < 300; ++id) {
+        server.AddDocument(id, contents[id], DocumentStatus::ACTUAL, {id % 7});
+        batch.push_back({ id, contents[id], DocumentStatus::ACTUAL, {id % 7} });
+    }
+    concurrent_server.AddDocuments(batch);
+    for (const int id : {3, 45, 46, 47, 150, 299}) {
+        server.RemoveDocument(id);
+        concurrent_server.RemoveDocument(id);
+    }
+    // Сегмент, в котором удалена большая часть документов, сжимается
+    for (int id = 10; id < 30; ++id) {
+        server.RemoveDocument(id);
+        concurrent_server.RemoveDocument(id);
+    }
+
+    const shared_ptr<const ConcurrentSearchServer::Snapshot> snapshot = concurrent_server.GetSnapshot();
+    ASSERT_EQUAL(snapshot->GetDocumentCount(), server.GetDocumentCount());
+    ASSERT_HINT(snapshot->GetSegmentCount() <= 16u, "Sealed deltas must be merged"s);
+
+    const auto assert_same = [](const vector<Document>& found, const vector<Document>& expected) {
+        ASSERT_EQUAL(found.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQUAL(found[i].id, expected[i].id);
+            ASSERT_HINT(found[i].relevance == expected[i].relevance, "Relevance must use corpus-wide IDF"s);
+            ASSERT_EQUAL(found[i].rating, expected[i].rating);
+        }
+    };
+    const auto is_odd = [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 1; };
+    for (int i = 0; i < 20; ++i) {
+        const string query = generate_text(1 + i % 3) + (i % 4 == 0 ? "-"s + words[i % words.size()] : ""s);
+        assert_same(snapshot->FindTopDocuments(query, size_t{300}), server.FindTopDocuments(query, size_t{300}));
+        assert_same(snapshot->FindTopDocuments(execution::par, query, DocumentStatus::BANNED),
+                    server.FindTopDocuments(query, DocumentStatus::BANNED));
+        assert_same(snapshot->FindTopDocuments(query, is_odd, 3), server.FindTopDocuments(query, is_odd, 3));
+        ASSERT(snapshot->MatchDocument(query, 120) == server.MatchDocument(query, 120));
+    }
+
+    // Повтор ID из запечатанного сегмента отвергает пачку целиком
+    bool is_rejected = false;
+    try {
+        concurrent_server.AddDocuments({{ 300, "cat"sv, DocumentStatus::ACTUAL, {} }, { 35, "dog"sv, DocumentStatus::ACTUAL, {} }});
+    } catch (const invalid_argument&) {
+        is_rejected = true;
+    }
+    ASSERT(is_rejected);
+    ASSERT(concurrent_server.GetSnapshot() == snapshot);
+    concurrent_server.AddDocuments({});
+    ASSERT_HINT(concurrent_server.GetSnapshot() == snapshot, "Empty batch must not publish a new generation"s);
+}
+
+
+void TestLatencyHistogram() {
+    LatencyHistogram histogram;
+    ASSERT_EQUAL(histogram.GetPercentile(0.5).count(), 0);
+    for (int value = 1; value <= 1000; ++value) {
+        histogram.Record(chrono::microseconds(value));
+    }
+    ASSERT_EQUAL(histogram.GetCount(), 1000u);
+    for (const auto& [percentile, expected] : {pair{0.5, 500'000.0}, pair{0.95, 950'000.0}, pair{0.99, 990'000.0}}) {
+        const double value = static_cast<double>(histogram.GetPercentile(percentile).count());
+        ASSERT_HINT(value >= expected && value <= expected * (1.0 + 1.0 / LatencyHistogram::SUB_BUCKET_COUNT),
+                    "Percentile must be an upper bound within bucket precision"s);
+    }
+    histogram.Record(chrono::nanoseconds(-5));
+    histogram.Record(chrono::nanoseconds::max());
+    ASSERT_EQUAL(histogram.GetCount(), 1002u);
+}
+
+
+void TestRequestQueue() {
+    SearchServer server("and"s);
+    server.AddDocument(1, "curly cat"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "curly dog"s, DocumentStatus::ACTUAL, {2});
+    server.AddDocument(3, "fluffy bird"s, DocumentStatus::BANNED, {3});
+
+    int minute = 0;
+    RequestQueue request_queue(server, chrono::minutes(10),
+                               [&minute] { return RequestQueue::Clock::time_point(chrono::minutes(minute)); });
+    for (; minute < 5; ++minute) {
+        request_queue.AddFindRequest("unknown"s);
+    }
+    request_queue.AddFindRequest("curly"s);
+    request_queue.AddFindRequest("bird"s, DocumentStatus::BANNED);
+    request_queue.AddFindRequest("curly"s, [](int document_id, DocumentStatus status, int rating) { return rating > 1; });
+    ASSERT_EQUAL(request_queue.GetNoResultRequests(), 5);
+
+    minute = 12;
+    ASSERT_EQUAL_HINT(request_queue.GetNoResultRequests(), 2, "Requests older than the window must be dropped"s);
+    minute = 100;
+    request_queue.AddFindRequest("unknown"s);
+    const RequestStats stats = request_queue.GetStats();
+    ASSERT_EQUAL(stats.total_requests, 9u);
+    ASSERT_EQUAL(stats.window_requests, 1u);
+    ASSERT_EQUAL(stats.window_no_result_requests, 1u);
+    ASSERT(stats.result_count_distribution == vector<uint64_t>({6, 2, 1, 0, 0, 0}));
+    ASSERT(stats.latency_p50 <= stats.latency_p95 && stats.latency_p95 <= stats.latency_p99);
+
+    RequestQueue shared_queue(server);
+    vector<thread> threads;
+    for (int thread_index = 0; thread_index < 4; ++thread_index) {
+        threads.emplace_back([&shared_queue, thread_index] {
+            for (int i = 0; i < 250; ++i) {
+                shared_queue.AddFindRequest(i % 2 == 0 ? "unknown"s : "curly"s);
+            }
+        });
+    }
+    for (thread& request_thread : threads) {
+        request_thread.join();
+    }
+    ASSERT_EQUAL(shared_queue.GetStats().total_requests, 1000u);
+    ASSERT_EQUAL(shared_queue.GetStats().window_requests, 1000u);
+    ASSERT_EQUAL(shared_queue.GetNoResultRequests(), 500);
+}
+
+
+void TestTraceHooks() {
+    ResetTraceStats();
+    SearchServer server("and"s);
+    server.AddDocument(1, "curly cat and dog"s, DocumentStatus::ACTUAL, {1});
+    server.AddDocument(2, "curly dog"s, DocumentStatus::ACTUAL, {2});
+    server.FindTopDocuments("curly -cat"s);
+    server.FindTopDocuments(execution::par, "curly dog"s, [](int document_id, DocumentStatus status, int rating) { return true; });
+
+    const vector<TraceStageStats> stats = GetTraceStats();
+    ASSERT_EQUAL(stats.size(), TRACE_STAGE_COUNT);
+    const auto stage_count = [&stats](TraceStage stage) { return stats[static_cast<size_t>(stage)].count; };
+    if constexpr (TRACING_ENABLED) {
+        ASSERT_EQUAL(stage_count(TraceStage::TOKENIZE_DOCUMENT), 2u);
+        ASSERT_EQUAL(stage_count(TraceStage::PARSE_QUERY), 2u);
+        ASSERT_EQUAL(stage_count(TraceStage::SCORE_DOCUMENTS), 2u);
+        ASSERT_EQUAL(stage_count(TraceStage::SORT_DOCUMENTS), 2u);
+        ASSERT_EQUAL(stage_count(TraceStage::EVALUATE_PREDICATE), 4u);
+        ASSERT(stats[static_cast<size_t>(TraceStage::PARSE_QUERY)].total_time.count() > 0);
+    } else {
+        for (const TraceStageStats& stage_stats : stats) {
+            ASSERT_EQUAL_HINT(stage_stats.count, 0u, "Disabled tracing must not record anything"s);
+        }
+    }
+
+    ResetTraceStats();
+    ASSERT_EQUAL(GetTraceStats()[static_cast<size_t>(TraceStage::PARSE_QUERY)].count, 0u);
+}
+
+
+void TestCorpusGenerator() {
+    CorpusConfig config;
+    config.vocabulary_size = 1'000;
+    config.document_length = 200;
+    config.query_length = 200;
+    config.stop_word_count = 5;
+    config.stop_word_ratio = 0.5;
+    config.minus_word_ratio = 0.5;
+
+    CorpusGenerator generator(config);
+    CorpusGenerator same_generator(config);
+    const string document = generator.GenerateDocument();
+    const string query = generator.GenerateQuery();
+    ASSERT_EQUAL_HINT(document, same_generator.GenerateDocument(), "Corpus must be reproducible for a fixed seed"s);
+    ASSERT_EQUAL(query, same_generator.GenerateQuery());
+    ASSERT_EQUAL(SplitIntoWords(document).size(), 200u);
+
+    SearchServer server(generator.GetStopWordsText());
+    server.AddDocument(1, document, DocumentStatus::ACTUAL, {1});
+    ASSERT_HINT(server.GetWordFrequencies(1).size() < 200u, "Stop words must be excluded from the document"s);
+    const auto [minus_count, stop_count] = [&query] {
+        int minus_words = 0;
+        int stop_words = 0;
+        for (const string_view word : SplitIntoWords(query)) {
+            minus_words += word[0] == '-' ? 1 : 0;
+            stop_words += word.substr(0, 4) == "stop"sv ? 1 : 0;
+        }
+        return pair{minus_words, stop_words};
+    }();
+    ASSERT(minus_count > 20 && minus_count < 80);
+    ASSERT(stop_count > 60 && stop_count < 140);
+
+    // Самое частое слово распределения Ципфа встречается чаще слова из середины словаря
+    ZipfDistribution distribution(1'000, 1.0);
+    mt19937 random_generator(1);
+    vector<int> rank_counts(1'000);
+    for (int i = 0; i < 10'000; ++i) {
+        ++rank_counts[distribution(random_generator)];
+    }
+    ASSERT(rank_counts[0] > 10 * rank_counts[500]);
+
+    const CorpusConfig parsed_config = ParseCorpusConfig({"vocabulary=100"sv, "zipf=1.5"sv, "seed=7"sv});
+    ASSERT_EQUAL(parsed_config.vocabulary_size, 100);
+    ASSERT_EQUAL(parsed_config.zipf_exponent, 1.5);
+    ASSERT_EQUAL(parsed_config.seed, 7u);
+    ASSERT_EQUAL(parsed_config.document_count, CorpusConfig().document_count);
+    for (const string_view argument : {"vocabulary"sv, "unknown=1"sv, "documents=ten"sv}) {
+        try {
+            ParseCorpusConfig({argument});
+            ASSERT_HINT(false, "Malformed benchmark parameter must be rejected"s);
+        } catch (const invalid_argument&) {
+        }
+    }
+}
+
+
+void TestFindTopDocumentsAfter() {
+    SearchServer server("and"s);
+    const vector<string> words = {"cat"s, "dog"s, "bird"s, "fish"s};
+    mt19937 generator(3);
+    for (int id = 0; id < 60; ++id) {
+        string document;
+        for (int i = 0; i < 4; ++i) {
+            document += words[uniform_int_distribution<size_t>(0, words.size() - 1)(generator)] + ' ';
+        }
+        server.AddDocument(id, document, id % 4 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, {id % 7});
+    }
+
+    const auto is_even = [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 0; };
+    for (const string& query : {"cat dog"s, "cat -fish"s, "bird fish dog"s}) {
+        for (const size_t page_size : {size_t{1}, size_t{4}, size_t{7}, size_t{100}}) {
+            const auto check_pages = [&page_size](const vector<Document>& expected, const auto& find_after, const vector<Document>& first_page) {
+                vector<Document> paged(first_page);
+                while (!paged.empty() && paged.size() % page_size == 0) {
+                    const vector<Document> page = find_after(paged.back());
+                    if (page.empty()) {
+                        break;
+                    }
+                    ASSERT(page.size() <= page_size);
+                    paged.insert(paged.end(), page.begin(), page.end());
+                }
+                ASSERT_EQUAL_HINT(paged.size(), expected.size(), "Pages must cover the whole result"s);
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    ASSERT_EQUAL(paged[i].id, expected[i].id);
+                    ASSERT_EQUAL(paged[i].relevance, expected[i].relevance);
+                }
+            };
+
+            check_pages(server.FindTopDocuments(query, 1'000),
+                        [&](const Document& after) { return server.FindTopDocumentsAfter(query, after, page_size); },
+                        server.FindTopDocuments(query, page_size));
+            check_pages(server.FindTopDocuments(query, DocumentStatus::BANNED, 1'000),
+                        [&](const Document& after) { return server.FindTopDocumentsAfter(query, after, DocumentStatus::BANNED, page_size); },
+                        server.FindTopDocuments(query, DocumentStatus::BANNED, page_size));
+            check_pages(server.FindTopDocuments(query, is_even, 1'000),
+                        [&](const Document& after) { return server.FindTopDocumentsAfter(query, after, is_even, page_size); },
+                        server.FindTopDocuments(query, is_even, page_size));
+        }
+    }
+}
+
+
+void TestPaginator() {
+    const vector<int> numbers = {1, 2, 3, 4, 5, 6, 7};
+    const auto pages = Paginate(numbers, 3);
+    ASSERT_EQUAL(pages.size(), 3u);
+    vector<size_t> page_sizes;
+    vector<int> items;
+    for (const auto& page : pages) {
+        page_sizes.push_back(page.size());
+        items.insert(items.end(), page.begin(), page.end());
+    }
+    ASSERT(page_sizes == vector<size_t>({3, 3, 1}));
+    ASSERT(items == numbers);
+    ASSERT_EQUAL(*pages.GetPage(2).begin(), 7);
+    ASSERT_EQUAL(pages.GetPage(3).size(), 0u);
+    ASSERT_EQUAL(Paginate(vector<int>(), 3).size(), 0u);
+    ASSERT(Paginate(vector<int>(), 3).begin() == Paginate(vector<int>(), 3).end());
+
+    // Для однонаправленных итераторов границы страниц находятся обходом
+    const list<int> number_list(numbers.begin(), numbers.end());
+    const auto list_pages = Paginate(number_list, 4);
+    ASSERT_EQUAL(list_pages.size(), 2u);
+    ASSERT_EQUAL(list_pages.GetPage(1).size(), 3u);
+    ASSERT_EQUAL(*list_pages.GetPage(1).begin(), 5);
+
+    try {
+        Paginate(numbers, 0);
+        ASSERT_HINT(false, "Zero page size must be rejected"s);
+    } catch (const invalid_argument&) {
+    }
+}
+
+
+void TestShardedSearchServer() {
+    const vector<string> words = {"cat"s, "dog"s, "bird"s, "fish"s, "and"s, "mouse"s, "horse"s};
+    mt19937 generator(11);
+    const auto generate_text = [&](int word_count) {
+        string text;
+        for (int i = 0; i < word_count; ++i) {
+            text += words[uniform_int_distribution<size_t>(0, words.size() - 1)(generator)] + ' ';
+        }
+        return text;
+    };
+    vector<string> contents;
+    for (int i = 0; i < 200; ++i) {
+        contents.push_back(generate_text(1 + i % 6));
+    }
+
+    SearchServer server("and"s);
+    ShardedSearchServer sharded_server("and"s, 3);
+    vector<RawDocument> batch;
+    for (int id = 0; id < 200; ++id) {
+        const DocumentStatus status = id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        server.AddDocument(id, contents[id], status, {id % 9, id % 4});
+        if (id < 100) {
+            sharded_server.AddDocument(id, contents[id], status, {id % 9, id % 4});
+        } else {
+            batch.push_back({ id, contents[id], status, {id % 9, id % 4} });
+        }
+    }
+    sharded_server.AddDocuments(batch);
+    for (const int id : {3, 50, 151}) {
+        server.RemoveDocument(id);
+        sharded_server.RemoveDocument(id);
+    }
+    ASSERT_EQUAL(sharded_server.GetDocumentCount(), server.GetDocumentCount());
+    ASSERT_EQUAL(sharded_server.GetShardCount(), 3u);
+    ASSERT_EQUAL(sharded_server.GetShard(1).GetDocumentCount(), 66);
+
+    const auto assert_same = [](const vector<Document>& sharded, const vector<Document>& expected) {
+        ASSERT_EQUAL(sharded.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQUAL(sharded[i].id, expected[i].id);
+            ASSERT_HINT(sharded[i].relevance == expected[i].relevance, "Relevance must use corpus-wide IDF"s);
+            ASSERT_EQUAL(sharded[i].rating, expected[i].rating);
+        }
+    };
+    const auto is_odd = [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 1; };
+    for (int i = 0; i < 30; ++i) {
+        const string query = generate_text(1 + i % 3) + (i % 4 == 0 ? "-"s + words[i % words.size()] : ""s);
+        for (const size_t result_count : {size_t{1}, size_t{5}, size_t{300}}) {
+            assert_same(sharded_server.FindTopDocuments(query, result_count), server.FindTopDocuments(query, result_count));
+            assert_same(sharded_server.FindTopDocuments(query, DocumentStatus::BANNED, result_count),
+                        server.FindTopDocuments(query, DocumentStatus::BANNED, result_count));
+            assert_same(sharded_server.FindTopDocuments(query, is_odd, result_count), server.FindTopDocuments(query, is_odd, result_count));
+        }
+        ASSERT(sharded_server.MatchDocument(query, 7) == server.MatchDocument(query, 7));
+    }
+
+    // Ошибка в пачке отвергает ее целиком до изменения шардов
+    for (const vector<RawDocument>& invalid_batch : {
+             vector<RawDocument>{{ 300, "cat"sv, DocumentStatus::ACTUAL, {} }, { 1, "dog"sv, DocumentStatus::ACTUAL, {} }},
+             vector<RawDocument>{{ 301, "cat"sv, DocumentStatus::ACTUAL, {} }, { 301, "dog"sv, DocumentStatus::ACTUAL, {} }},
+             vector<RawDocument>{{ 302, "cat"sv, DocumentStatus::ACTUAL, {} }, { 303, "d\x12og"sv, DocumentStatus::ACTUAL, {} }},
+             vector<RawDocument>{{ 304, "cat"sv, DocumentStatus::ACTUAL, {} }, { -1, "dog"sv, DocumentStatus::ACTUAL, {} }}}) {
+        try {
+            sharded_server.AddDocuments(invalid_batch);
+            ASSERT_HINT(false, "Invalid batch must be rejected"s);
+        } catch (const invalid_argument&) {
+        }
+    }
+    ASSERT_EQUAL(sharded_server.GetDocumentCount(), server.GetDocumentCount());
+}
+
+
+void TestLoadDocuments() {
+    const string path = (filesystem::temp_directory_path() / ("search_server_loader_test_"s + to_string(getpid()) + ".tsv"s)).string();
+    const auto write_file = [&path](const string& text) {
+        ofstream output(path, ios::binary | ios::trunc);
+        output << text;
+    };
+    const vector<string> status_names = {"ACTUAL"s, "IRRELEVANT"s, "BANNED"s, "REMOVED"s};
+
+    SearchServer expected("and with"s);
+    string file_text;
+    for (int id = 1; id <= 300; ++id) {
+        const string content = "pet"s + to_string(id % 7) + " and rat"s + to_string(id % 11) + (id % 3 == 0 ? " curly hair"s : " cat"s);
+        const DocumentStatus status = static_cast<DocumentStatus>(id % 4);
+        const vector<int> ratings = id % 10 == 0 ? vector<int>{} : vector<int>{id % 9, -id % 5};
+        expected.AddDocument(id * 2, content, status, ratings);
+        file_text += to_string(id * 2) + '\t' + status_names[id % 4] + '\t';
+        for (const int rating : ratings) {
+            file_text += to_string(rating) + ' ';
+        }
+        file_text += '\t' + content + (id % 13 == 0 ? "\r\n"s : "\n"s) + (id % 17 == 0 ? "\n"s : ""s);
+    }
+    // Последняя строка без перевода строки
+    file_text += "1000\tACTUAL\t5\tfunny cat"s;
+    expected.AddDocument(1000, "funny cat"s, DocumentStatus::ACTUAL, {5});
+    write_file(file_text);
+
+    SearchServer loaded("and with"s);
+    const LoadStats stats = LoadDocuments(loaded, path, { 64, 3, 2 });
+    ASSERT_EQUAL(stats.document_count, 301u);
+    ASSERT_EQUAL(stats.byte_count, file_text.size());
+    ASSERT_EQUAL(loaded.GetDocumentCount(), expected.GetDocumentCount());
+    for (int index = 0; index < expected.GetDocumentCount(); ++index) {
+        ASSERT_EQUAL_HINT(loaded.GetDocumentId(index), expected.GetDocumentId(index), "Documents must be added in file order"s);
+    }
+    for (const string& query : {"pet3 curly"s, "rat5 -hair"s, "funny cat"s, "pet1 and rat10"s}) {
+        for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED, DocumentStatus::REMOVED}) {
+            const vector<Document> result = loaded.FindTopDocuments(query, status, 500);
+            const vector<Document> expected_result = expected.FindTopDocuments(query, status, 500);
+            ASSERT_EQUAL(result.size(), expected_result.size());
+            for (size_t i = 0; i < result.size(); ++i) {
+                ASSERT_EQUAL(result[i].id, expected_result[i].id);
+                ASSERT_EQUAL(result[i].relevance, expected_result[i].relevance);
+                ASSERT_EQUAL(result[i].rating, expected_result[i].rating);
+            }
+        }
+    }
+    ASSERT(loaded.GetWordFrequencies(6) == expected.GetWordFrequencies(6));
+
+    // Повторная загрузка того же файла: ID уже заняты
+    try {
+        LoadDocuments(loaded, path, { 64, 2, 2 });
+        ASSERT_HINT(false, "Duplicate ids must be rejected"s);
+    } catch (const invalid_argument&) {
+    }
+
+    for (const string& invalid_text : {"1\tACTUAL\t1\tcat\n2\tUNKNOWN\t1\tdog\n"s, "1\tACTUAL\tcat\n"s,
+                                       "x1\tACTUAL\t1\tcat\n"s, "1\tACTUAL\t1 a\tcat\n"s, "1\tACTUAL\t1\td\x12og\n"s,
+                                       "1\tACTUAL\t1\tcat\n1\tACTUAL\t1\tdog\n"s}) {
+        write_file(invalid_text);
+        SearchServer server("and with"s);
+        try {
+            LoadDocuments(server, path, { 8, 2, 1 });
+            ASSERT_HINT(false, "Invalid record must be rejected"s);
+        } catch (const invalid_argument&) {
+        }
+    }
+    filesystem::remove(path);
+}
+
+void TestParallelFindTopDocuments() {
+    SearchServer server("and with"s);
+    int document_id = 0;
+    for (const string& text : {"white cat and yellow hat"s, "curly cat curly tail"s, "nasty dog with big eyes"s,
+                               "nasty pigeon john"s, "funny pet and nasty rat"s, "fluffy snake or cat"s,
+                               "cat and dog"s, "big cat fancy collar"s}) {
+        ++document_id;
+        server.AddDocument(document_id, text, document_id % 3 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL,
+                           {document_id, 1, 2});
+    }
+    for (const string& query : {"curly nasty cat"s, "curly nasty -cat"s, "cat -curly -dog"s, "-big big"s, "nobody"s}) {
+        const vector<Document> expected = server.FindTopDocuments(query);
+        for (const vector<Document>& result : {server.FindTopDocuments(execution::seq, query),
+                                               server.FindTopDocuments(execution::par, query)}) {
+            ASSERT_EQUAL_HINT(result.size(), expected.size(), "Parallel search must find the same documents"s);
+            for (size_t i = 0; i < result.size(); ++i) {
+                ASSERT_EQUAL(result[i].id, expected[i].id);
+                ASSERT(abs(result[i].relevance - expected[i].relevance) < EPSILON);
+                ASSERT_EQUAL(result[i].rating, expected[i].rating);
+            }
+        }
+        ASSERT_EQUAL(server.FindTopDocuments(execution::par, query, DocumentStatus::BANNED).size(),
+                     server.FindTopDocuments(query, DocumentStatus::BANNED).size());
+    }
+}
+
+
+void TestParallelMatchDocument() {
+    SearchServer server("in the"s);
+    server.AddDocument(1, "cat in the city"s, DocumentStatus::BANNED, {1, 2, 3});
+    for (const string& query : {"cat in the city"s, "city dog cat"s, "cat -in the city"s, "cat -in the -city"s, "dog"s}) {
+        ASSERT(server.MatchDocument(execution::par, query, 1) == server.MatchDocument(query, 1));
+        ASSERT(server.MatchDocument(execution::seq, query, 1) == server.MatchDocument(query, 1));
+    }
+    ASSERT(server.MatchDocument(execution::par, "city dog cat"s, 1) == tuple(vector<string_view> {"cat"sv, "city"sv}, DocumentStatus::BANNED));
+
+    // Слова ссылаются на словарь индекса, а не на текст запроса, и переживают его
+    const vector<string_view> matched_words = get<0>(server.MatchDocument("city dog cat"s, 1));
+    ASSERT(matched_words == vector<string_view>({"cat"sv, "city"sv}));
+    ASSERT(matched_words[0].data() == get<0>(server.MatchDocument(execution::par, "cat"s, 1))[0].data());
+}
+
+
+void TestProcessQueries() {
+    SearchServer server("and with"s);
+    int document_id = 0;
+    for (const string& text : {"funny pet and nasty rat"s, "funny pet with curly hair"s, "funny pet and not very nasty rat"s,
+                               "pet with rat and rat and rat"s, "nasty rat with curly hair"s}) {
+        server.AddDocument(++document_id, text, DocumentStatus::ACTUAL, {1, 2});
+    }
+    const vector<string> queries = {"nasty rat -not"s, "not very funny nasty pet"s, "curly hair"s, "nobody"s};
+
+    const vector<vector<Document>> documents_by_query = ProcessQueries(server, queries);
+    ASSERT_EQUAL(documents_by_query.size(), queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const vector<Document> expected = server.FindTopDocuments(queries[i]);
+        ASSERT_EQUAL(documents_by_query[i].size(), expected.size());
+        for (size_t j = 0; j < expected.size(); ++j) {
+            ASSERT_EQUAL(documents_by_query[i][j].id, expected[j].id);
+        }
+    }
+
+    const vector<Document> joined_documents = ProcessQueriesJoined(server, queries);
+    size_t position = 0;
+    for (const vector<Document>& documents : documents_by_query) {
+        for (const Document& document : documents) {
+            ASSERT_HINT(position < joined_documents.size(), "Joined results must contain every found document"s);
+            ASSERT_EQUAL(joined_documents[position].id, document.id);
+            ++position;
+        }
+    }
+    ASSERT_EQUAL(joined_documents.size(), position);
+    ASSERT(ProcessQueriesJoined(server, {}).empty());
+}
+
+
 void TestSearchServer() {
     RUN_TEST(TestAddDocument);
     RUN_TEST(TestExcludeStopWordsFromAddedDocumentContent);
@@ -405,4 +1726,34 @@ void TestSearchServer() {
     RUN_TEST(TestFilterDocumentsByPredicateFunc);
     RUN_TEST(TestFindDocumentsByStatus);
     RUN_TEST(TestComputationOfDocumentRelevance);
+    RUN_TEST(TestFindTopDocumentsResultCount);
+    RUN_TEST(TestGetWordFrequencies);
+    RUN_TEST(TestFilterAfterReaddingDocument);
+    RUN_TEST(TestTermStatistics);
+    RUN_TEST(TestRemoveDocument);
+    RUN_TEST(TestCompact);
+    RUN_TEST(TestRemoveDuplicates);
+    RUN_TEST(TestQueryAllocationsDoNotDependOnWordCount);
+    RUN_TEST(TestQueryArena);
+    RUN_TEST(TestPostingList);
+    RUN_TEST(TestLiveOrdinals);
+    RUN_TEST(TestScoreAccumulator);
+    RUN_TEST(TestGetMemoryUsage);
+    RUN_TEST(TestSnapshotRoundTrip);
+    RUN_TEST(TestAddDocuments);
+    RUN_TEST(TestPrunedTopDocumentsMatchExhaustiveSearch);
+    RUN_TEST(TestResultCache);
+    RUN_TEST(TestConcurrentSearchServerStress);
+    RUN_TEST(TestConcurrentSearchServerSegments);
+    RUN_TEST(TestLatencyHistogram);
+    RUN_TEST(TestRequestQueue);
+    RUN_TEST(TestTraceHooks);
+    RUN_TEST(TestCorpusGenerator);
+    RUN_TEST(TestFindTopDocumentsAfter);
+    RUN_TEST(TestPaginator);
+    RUN_TEST(TestShardedSearchServer);
+    RUN_TEST(TestLoadDocuments);
+    RUN_TEST(TestParallelFindTopDocuments);
+    RUN_TEST(TestParallelMatchDocument);
+    RUN_TEST(TestProcessQueries);
 }
\ No newline at end of file
@@ -58,4 +58,64 @@ void TestFindDocumentsByStatus();
 
 void TestComputationOfDocumentRelevance();
 
+void TestFindTopDocumentsResultCount();
+
+void TestGetWordFrequencies();
+
+void TestFilterAfterReaddingDocument();
+
+void TestTermStatistics();
+
+void TestRemoveDocument();
+
+void TestCompact();
+
+void TestRemoveDuplicates();
+
+void TestQueryAllocationsDoNotDependOnWordCount();
+
+void TestQueryArena();
+
+void TestPostingList();
+
+void TestLiveOrdinals();
+
+void TestScoreAccumulator();
+
+void TestGetMemoryUsage();
+
+void TestSnapshotRoundTrip();
+
+void TestAddDocuments();
+
+void TestPrunedTopDocumentsMatchExhaustiveSearch();
+
+void TestResultCache();
+
+void TestConcurrentSearchServerStress();
+
+void TestConcurrentSearchServerSegments();
+
+void TestLatencyHistogram();
+
+void TestRequestQueue();
+
+void TestTraceHooks();
+
+void TestCorpusGenerator();
+
+void TestFindTopDocumentsAfter();
+
+void TestPaginator();
+
+void TestShardedSearchServer();
+
+void TestLoadDocuments();
+
+void TestParallelFindTopDocuments();
+
+void TestParallelMatchDocument();
+
+void TestProcessQueries();
+
 void TestSearchServer();
\ No newline at end of file
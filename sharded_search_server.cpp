@@ -0,0 +1,87 @@
+#include "sharded_search_server.h"
+
+#include <numeric>
+#include <unordered_set>
+
+
+void ShardedSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    shards_[GetShardIndex(document_id)].AddDocument(document_id, document, status, ratings);
+}
+
+
+void ShardedSearchServer::AddDocuments(const std::vector<RawDocument>& documents) {
+    std::vector<std::vector<RawDocument>> shard_documents(shards_.size());
+    std::vector<size_t> shard_positions;
+    shard_positions.reserve(documents.size());
+    for (const RawDocument& document : documents) {
+        std::vector<RawDocument>& batch = shard_documents[GetShardIndex(document.id)];
+        shard_positions.push_back(batch.size());
+        batch.push_back(document);
+    }
+
+    // Каждый шард разбирает свои документы в своем потоке; индексы шардов пока не меняются
+    std::vector<size_t> shard_indexes(shards_.size());
+    std::iota(shard_indexes.begin(), shard_indexes.end(), 0);
+    std::vector<std::vector<SearchServer::PreparedDocuments>> prepared_documents(shards_.size());
+    std::for_each(std::execution::par, shard_indexes.begin(), shard_indexes.end(),
+        [this, &shard_documents, &prepared_documents](size_t shard_index) {
+            prepared_documents[shard_index].push_back(shards_[shard_index].PrepareDocuments(shard_documents[shard_index]));
+        });
+
+    // Проверка в исходном порядке документов, чтобы ошибка была той же, что у SearchServer
+    std::unordered_set<int> batch_ids;
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const size_t shard_index = GetShardIndex(documents[i].id);
+        shards_[shard_index].CheckPreparedDocument(prepared_documents[shard_index].front(), shard_positions[i], batch_ids);
+    }
+
+    std::for_each(std::execution::par, shard_indexes.begin(), shard_indexes.end(), [this, &prepared_documents](size_t shard_index) {
+        shards_[shard_index].AddPreparedDocuments(std::move(prepared_documents[shard_index]));
+    });
+}
+
+
+void ShardedSearchServer::RemoveDocument(int document_id) {
+    shards_[GetShardIndex(document_id)].RemoveDocument(document_id);
+}
+
+
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t result_count) const {
+    return GetPartitionedSearch().FindTopDocuments(std::execution::par, raw_query, status, result_count);
+}
+
+
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view raw_query, size_t result_count) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL, result_count);
+}
+
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> ShardedSearchServer::MatchDocument(std::string_view raw_query,
+                                                                                             int document_id) const {
+    return shards_[GetShardIndex(document_id)].MatchDocument(raw_query, document_id);
+}
+
+
+int ShardedSearchServer::GetDocumentCount() const {
+    return GetPartitionedSearch().GetDocumentCount();
+}
+
+
+size_t ShardedSearchServer::GetShardCount() const {
+    return shards_.size();
+}
+
+
+const SearchServer& ShardedSearchServer::GetShard(size_t shard_index) const {
+    return shards_.at(shard_index);
+}
+
+
+size_t ShardedSearchServer::GetShardIndex(int document_id) const {
+    return document_id < 0 ? 0 : static_cast<size_t>(document_id) % shards_.size();
+}
+
+
+PartitionedSearch ShardedSearchServer::GetPartitionedSearch() const {
+    return PartitionedSearch(shard_pointers_);
+}
\ No newline at end of file
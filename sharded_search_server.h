@@ -0,0 +1,82 @@
+#pragma once
+#include "document.h"
+#include "partitioned_search.h"
+#include "search_server.h"
+
+#include <execution>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// Индекс, разбитый на шарды по ID документа: документ хранится в шарде document_id % shard_count.
+// Запрос выполняется на всех шардах параллельно через PartitionedSearch, поэтому релевантность
+// и выдача совпадают с одним SearchServer на тех же документах.
+class ShardedSearchServer {
+public:
+    template <typename StopWords>
+    ShardedSearchServer(const StopWords& stop_words, size_t shard_count);
+
+    // Поиск хранит указатели на шарды, поэтому сервер перемещается, но не копируется
+    ShardedSearchServer(const ShardedSearchServer&) = delete;
+    ShardedSearchServer& operator=(const ShardedSearchServer&) = delete;
+    ShardedSearchServer(ShardedSearchServer&&) = default;
+    ShardedSearchServer& operator=(ShardedSearchServer&&) = default;
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    // Документы раскладываются по шардам и индексируются параллельно. Все документы проверяются
+    // до изменения шардов, так что при ошибке индекс остается прежним, как и у SearchServer.
+    void AddDocuments(const std::vector<RawDocument>& documents);
+
+    void RemoveDocument(int document_id);
+
+    template <DocumentPredicate PredicateFunc>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, PredicateFunc predicate_func,
+                                           size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                           size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, size_t result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    // Строки принадлежат словарю шарда документа
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    int GetDocumentCount() const;
+
+    size_t GetShardCount() const;
+
+    const SearchServer& GetShard(size_t shard_index) const;
+
+private:
+    std::vector<SearchServer> shards_;
+    std::vector<const SearchServer*> shard_pointers_;
+
+    // Отрицательный ID попадает в нулевой шард, который его и отвергнет
+    size_t GetShardIndex(int document_id) const;
+
+    PartitionedSearch GetPartitionedSearch() const;
+};
+
+
+template <typename StopWords>
+ShardedSearchServer::ShardedSearchServer(const StopWords& stop_words, size_t shard_count) {
+    if (shard_count == 0) {
+        throw std::invalid_argument("Shard count must be positive");
+    }
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.emplace_back(stop_words);
+    }
+    for (const SearchServer& shard : shards_) {
+        shard_pointers_.push_back(&shard);
+    }
+}
+
+
+template <DocumentPredicate PredicateFunc>
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view raw_query, PredicateFunc predicate_func,
+                                                            size_t result_count) const {
+    return GetPartitionedSearch().FindTopDocuments(std::execution::par, raw_query, predicate_func, result_count);
+}
\ No newline at end of file
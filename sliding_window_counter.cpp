@@ -0,0 +1,51 @@
+#include "sliding_window_counter.h"
+
+#include <algorithm>
+
+namespace {
+
+std::uint32_t GetBucketSlot(std::uint64_t bucket) {
+    return static_cast<std::uint32_t>(bucket >> 32);
+}
+
+std::uint64_t GetBucketCount(std::uint64_t bucket) {
+    return bucket & 0xFFFFFFFF;
+}
+
+} // namespace
+
+
+SlidingWindowCounter::SlidingWindowCounter(Clock::duration window, size_t bucket_count)
+    : bucket_width_(std::max<Clock::duration>(window / std::max<size_t>(bucket_count, 1), Clock::duration(1))),
+      buckets_(std::max<size_t>(bucket_count, 1)) {}
+
+
+void SlidingWindowCounter::Add(Clock::time_point now, std::uint32_t count) {
+    const std::uint32_t slot = GetSlot(now);
+    std::atomic<std::uint64_t>& bucket = buckets_[slot % buckets_.size()];
+    std::uint64_t current = bucket.load(std::memory_order_relaxed);
+    std::uint64_t updated;
+    do {
+        const std::uint64_t current_count = GetBucketSlot(current) == slot ? GetBucketCount(current) : 0;
+        updated = (static_cast<std::uint64_t>(slot) << 32) | std::min<std::uint64_t>(current_count + count, 0xFFFFFFFF);
+    } while (!bucket.compare_exchange_weak(current, updated, std::memory_order_relaxed));
+}
+
+
+std::uint64_t SlidingWindowCounter::Get(Clock::time_point now) const {
+    const std::uint32_t slot = GetSlot(now);
+    std::uint64_t total_count = 0;
+    for (const std::atomic<std::uint64_t>& bucket : buckets_) {
+        const std::uint64_t value = bucket.load(std::memory_order_relaxed);
+        // Разность слотов считается по модулю 2^32, поэтому переполнение номера не мешает
+        if (static_cast<std::uint32_t>(slot - GetBucketSlot(value)) < buckets_.size()) {
+            total_count += GetBucketCount(value);
+        }
+    }
+    return total_count;
+}
+
+
+std::uint32_t SlidingWindowCounter::GetSlot(Clock::time_point now) const {
+    return static_cast<std::uint32_t>(now.time_since_epoch() / bucket_width_);
+}
\ No newline at end of file
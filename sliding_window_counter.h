@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Потокобезопасный счетчик событий за последний интервал window. Интервал разбит на
+// bucket_count корзин; каждая корзина - одно атомарное слово, в старших 32 битах которого
+// номер временного слота, а в младших - число событий в нем. Устаревшая корзина
+// переиспользуется без блокировок через compare_exchange, поэтому точность окна равна
+// ширине корзины.
+class SlidingWindowCounter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    SlidingWindowCounter(Clock::duration window, size_t bucket_count);
+
+    void Add(Clock::time_point now, std::uint32_t count = 1);
+
+    std::uint64_t Get(Clock::time_point now) const;
+
+private:
+    Clock::duration bucket_width_;
+    std::vector<std::atomic<std::uint64_t>> buckets_;
+
+    std::uint32_t GetSlot(Clock::time_point now) const;
+};
\ No newline at end of file
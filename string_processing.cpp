@@ -1,14 +1,50 @@
 #include "string_processing.h"
 
-#include <sstream>
-
-std::vector<std::string> SplitIntoWords(const std::string& text) {
-    std::vector<std::string> words;
-    std::istringstream stream(text);
-    std::string word;
-    while (stream >> word) {
-        words.push_back(word);
+namespace {
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+template <typename WordHandler>
+void ForEachWord(std::string_view text, WordHandler word_handler) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && IsSpace(text[pos])) {
+            ++pos;
+        }
+        const size_t word_begin = pos;
+        while (pos < text.size() && !IsSpace(text[pos])) {
+            ++pos;
+        }
+        if (word_begin != pos) {
+            word_handler(text.substr(word_begin, pos - word_begin));
+        }
     }
+}
+
+template <typename Words>
+void AppendWords(std::string_view text, Words& words) {
+    size_t word_count = 0;
+    ForEachWord(text, [&word_count](std::string_view) { ++word_count; });
+
+    words.reserve(word_count);
+    ForEachWord(text, [&words](std::string_view word) { words.push_back(word); });
+}
+
+} // namespace
+
+std::vector<std::string_view> SplitIntoWords(std::string_view text) {
+    std::vector<std::string_view> words;
+    AppendWords(text, words);
+
+    return words;
+}
+
+
+std::pmr::vector<std::string_view> SplitIntoWords(std::string_view text, std::pmr::memory_resource* resource) {
+    std::pmr::vector<std::string_view> words(resource);
+    AppendWords(text, words);
 
     return words;
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #pragma once
 
-#include <string>
+#include <memory_resource>
+#include <string_view>
 #include <vector>
 
-std::vector<std::string> SplitIntoWords(const std::string& text);
\ No newline at end of file
+// Слова возвращаются как представления исходного текста без копирования
+std::vector<std::string_view> SplitIntoWords(std::string_view text);
+
+// То же, но вектор размещается в resource (например, в арене запроса)
+std::pmr::vector<std::string_view> SplitIntoWords(std::string_view text, std::pmr::memory_resource* resource);
\ No newline at end of file
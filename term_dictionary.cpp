@@ -0,0 +1,67 @@
+#include "term_dictionary.h"
+
+
+TermDictionary::TermDictionary(const TermDictionary& other)
+    : terms_(other.terms_) {
+    RebuildTermIds();
+}
+
+
+TermDictionary& TermDictionary::operator=(const TermDictionary& other) {
+    if (this != &other) {
+        terms_ = other.terms_;
+        RebuildTermIds();
+    }
+    return *this;
+}
+
+
+int TermDictionary::FindTerm(std::string_view term) const {
+    const auto term_it = term_ids_.find(term);
+    return term_it == term_ids_.end() ? NO_TERM : term_it->second;
+}
+
+
+int TermDictionary::AddTerm(std::string_view term) {
+    const int term_id = FindTerm(term);
+    if (term_id != NO_TERM) {
+        return term_id;
+    }
+    const int new_term_id = static_cast<int>(terms_.size());
+    terms_.emplace_back(term);
+    term_ids_.emplace(terms_.back(), new_term_id);
+    return new_term_id;
+}
+
+
+std::string_view TermDictionary::GetTerm(int term_id) const {
+    return terms_.at(term_id);
+}
+
+
+int TermDictionary::GetTermCount() const {
+    return static_cast<int>(terms_.size());
+}
+
+
+std::size_t TermDictionary::GetMemoryUsage() const {
+    // Оценка: строки с их буферами, узлы хеш-таблицы и массив корзин
+    std::size_t memory_usage = terms_.size() * sizeof(std::string);
+    for (const std::string& term : terms_) {
+        if (term.capacity() > std::string().capacity()) {
+            memory_usage += term.capacity() + 1;
+        }
+    }
+    memory_usage += term_ids_.size() * (sizeof(void*) + sizeof(std::pair<const std::string_view, int>) + sizeof(std::size_t))
+                    + term_ids_.bucket_count() * sizeof(void*);
+    return memory_usage;
+}
+
+
+void TermDictionary::RebuildTermIds() {
+    term_ids_.clear();
+    term_ids_.reserve(terms_.size());
+    for (int term_id = 0; term_id < static_cast<int>(terms_.size()); ++term_id) {
+        term_ids_.emplace(terms_[term_id], term_id);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Словарь терминов: каждому слову при индексации выдается плотный целочисленный ID.
+// Тексты слов хранятся в deque, поэтому string_view на них не инвалидируются при добавлении.
+class TermDictionary {
+public:
+    static constexpr int NO_TERM = -1;
+
+    TermDictionary() = default;
+
+    TermDictionary(const TermDictionary& other);
+
+    TermDictionary(TermDictionary&& other) = default;
+
+    TermDictionary& operator=(const TermDictionary& other);
+
+    TermDictionary& operator=(TermDictionary&& other) = default;
+
+    int FindTerm(std::string_view term) const;
+
+    int AddTerm(std::string_view term);
+
+    std::string_view GetTerm(int term_id) const;
+
+    int GetTermCount() const;
+
+    std::size_t GetMemoryUsage() const;
+
+private:
+    std::deque<std::string> terms_;
+    std::unordered_map<std::string_view, int> term_ids_;
+
+    void RebuildTermIds();
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "trace_hooks.h"
+
+namespace {
+
+constexpr auto STAGE_NAMES = std::to_array<std::string_view>({
+    "parse_query",
+    "score_documents",
+    "evaluate_predicate",
+    "sort_documents",
+    "tokenize_document",
+});
+
+static_assert(STAGE_NAMES.size() == TRACE_STAGE_COUNT, "Every TraceStage needs a name");
+
+} // namespace
+
+
+namespace trace_detail {
+
+std::array<StageCounters, TRACE_STAGE_COUNT> stage_counters;
+
+} // namespace trace_detail
+
+
+std::vector<TraceStageStats> GetTraceStats() {
+    std::vector<TraceStageStats> stats;
+    stats.reserve(TRACE_STAGE_COUNT);
+    for (std::size_t stage = 0; stage < TRACE_STAGE_COUNT; ++stage) {
+        const trace_detail::StageCounters& counters = trace_detail::stage_counters[stage];
+        stats.push_back({ STAGE_NAMES[stage], counters.count.load(std::memory_order_relaxed),
+                          std::chrono::nanoseconds(counters.total_nanoseconds.load(std::memory_order_relaxed)) });
+    }
+    return stats;
+}
+
+
+void ResetTraceStats() {
+    for (trace_detail::StageCounters& counters : trace_detail::stage_counters) {
+        counters.count.store(0, std::memory_order_relaxed);
+        counters.total_nanoseconds.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+void PrintTraceStats(std::ostream& output) {
+    if (!TRACING_ENABLED) {
+        output << "Tracing is disabled, rebuild with -DSEARCH_SERVER_TRACING" << std::endl;
+        return;
+    }
+    for (const TraceStageStats& stage_stats : GetTraceStats()) {
+        output << stage_stats.name << ": " << stage_stats.count << " calls, "
+               << std::chrono::duration_cast<std::chrono::microseconds>(stage_stats.total_time).count() << " us" << std::endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// Трассировка горячих участков SearchServer. Включается при сборке с -DSEARCH_SERVER_TRACING;
+// без этого макросы TRACE_SCOPE и TRACE_COUNT раскрываются в пустоту, а статистика остается нулевой.
+
+#ifdef SEARCH_SERVER_TRACING
+inline constexpr bool TRACING_ENABLED = true;
+#else
+inline constexpr bool TRACING_ENABLED = false;
+#endif
+
+enum class TraceStage {
+    PARSE_QUERY,
+    SCORE_DOCUMENTS,
+    EVALUATE_PREDICATE,
+    SORT_DOCUMENTS,
+    TOKENIZE_DOCUMENT,
+    // Не стадия: число стадий, новые добавляются перед ним
+    COUNT,
+};
+
+inline constexpr std::size_t TRACE_STAGE_COUNT = static_cast<std::size_t>(TraceStage::COUNT);
+
+struct TraceStageStats {
+    std::string_view name;
+    std::uint64_t count = 0;
+    // Для стадий, которые только считаются (TRACE_COUNT), время нулевое
+    std::chrono::nanoseconds total_time{0};
+};
+
+namespace trace_detail {
+
+struct StageCounters {
+    std::atomic<std::uint64_t> count = 0;
+    std::atomic<std::int64_t> total_nanoseconds = 0;
+};
+
+extern std::array<StageCounters, TRACE_STAGE_COUNT> stage_counters;
+
+inline void Count(TraceStage stage) {
+    stage_counters[static_cast<std::size_t>(stage)].count.fetch_add(1, std::memory_order_relaxed);
+}
+
+class ScopedTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ScopedTimer(TraceStage stage)
+        : stage_(stage) {}
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        StageCounters& counters = stage_counters[static_cast<std::size_t>(stage_)];
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.total_nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time_).count(),
+                                             std::memory_order_relaxed);
+    }
+
+private:
+    const TraceStage stage_;
+    const Clock::time_point start_time_ = Clock::now();
+};
+
+} // namespace trace_detail
+
+#ifdef SEARCH_SERVER_TRACING
+#define TRACE_CONCAT_INTERNAL(X, Y) X##Y
+#define TRACE_CONCAT(X, Y) TRACE_CONCAT_INTERNAL(X, Y)
+#define TRACE_SCOPE(stage) const trace_detail::ScopedTimer TRACE_CONCAT(trace_guard_, __LINE__)(stage)
+#define TRACE_COUNT(stage) trace_detail::Count(stage)
+#else
+#define TRACE_SCOPE(stage) static_cast<void>(0)
+#define TRACE_COUNT(stage) static_cast<void>(0)
+#endif
+
+// Накопленные с запуска (или последнего сброса) число проходов и суммарное время по стадиям
+std::vector<TraceStageStats> GetTraceStats();
+
+void ResetTraceStats();
+
+void PrintTraceStats(std::ostream& output);
\ No newline at end of file